@@ -57,6 +57,7 @@ public class OneButtonLevelGeneration : ModuleRules
 				"WaterEditor",
 				"ToolMenus",
 				"Foliage",
+				"Json",
 			}  
 			);
 		
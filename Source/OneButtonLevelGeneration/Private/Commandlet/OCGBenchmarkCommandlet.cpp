@@ -0,0 +1,228 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Commandlet/OCGBenchmarkCommandlet.h"
+
+#include "OCGLog.h"
+#include "Component/OCGMapGenerateComponent.h"
+#include "Data/MapPreset.h"
+#include "Dom/JsonObject.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Utils/OCGGenerationStats.h"
+#include "Utils/OCGParallelUtils.h"
+
+namespace
+{
+	FString GetMapChecksum(const TArray<uint16>& InMap)
+	{
+		return FString::Printf(TEXT("%08x"), FCrc::MemCrc32(InMap.GetData(), InMap.Num() * sizeof(uint16)));
+	}
+}
+
+UOCGBenchmarkCommandlet::UOCGBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Times the map generation stages of a map preset and writes per stage times and map checksums as JSON");
+	HelpUsage = TEXT("-run=OCGBenchmark -Preset=/Game/Path/MapPreset [-Resolutions=1009x1009,2017x2017] [-Seeds=1337,42] [-Repeats=1] [-Output=File.json]");
+}
+
+int32 UOCGBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString PresetPath;
+	if (!FParse::Value(*Params, TEXT("Preset="), PresetPath))
+	{
+		UE_LOG(LogOCGModule, Error, TEXT("Missing -Preset. Usage: %s"), *HelpUsage);
+		return 1;
+	}
+
+	const UMapPreset* SourcePreset = LoadObject<UMapPreset>(nullptr, *PresetPath);
+	if (!SourcePreset)
+	{
+		UE_LOG(LogOCGModule, Error, TEXT("Failed to load map preset %s"), *PresetPath);
+		return 1;
+	}
+
+	TArray<FIntPoint> Resolutions;
+	FString ResolutionsText;
+	if (FParse::Value(*Params, TEXT("Resolutions="), ResolutionsText, false))
+	{
+		if (!ParseResolutions(ResolutionsText, Resolutions))
+		{
+			UE_LOG(LogOCGModule, Error, TEXT("Invalid -Resolutions=%s, expected a list like 1009x1009,2017x2017"), *ResolutionsText);
+			return 1;
+		}
+	}
+	else
+	{
+		Resolutions.Add(SourcePreset->MapResolution);
+	}
+
+	TArray<int32> Seeds;
+	FString SeedsText;
+	if (FParse::Value(*Params, TEXT("Seeds="), SeedsText, false))
+	{
+		if (!ParseSeeds(SeedsText, Seeds))
+		{
+			UE_LOG(LogOCGModule, Error, TEXT("Invalid -Seeds=%s, expected a list like 1337,42"), *SeedsText);
+			return 1;
+		}
+	}
+	else
+	{
+		Seeds.Add(SourcePreset->Seed);
+	}
+
+	int32 Repeats = 1;
+	FParse::Value(*Params, TEXT("Repeats="), Repeats);
+	Repeats = FMath::Max(Repeats, 1);
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("OCG") / TEXT("Benchmark")
+		/ FString::Printf(TEXT("Benchmark_%s.json"), *FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S")));
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("OneButtonLevelGeneration"));
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("Preset"), SourcePreset->GetPathName());
+	Root->SetStringField(TEXT("PluginVersion"), Plugin.IsValid() ? Plugin->GetDescriptor().VersionName : TEXT("Unknown"));
+	Root->SetStringField(TEXT("Platform"), FPlatformProperties::IniPlatformName());
+	Root->SetNumberField(TEXT("NumWorkers"), FOCGParallelUtils::GetNumWorkers(SourcePreset->MaxGenerationThreads));
+
+	// Every repeat of the same resolution and seed must give the same maps
+	bool bSucceeded = true;
+	TArray<TSharedPtr<FJsonValue>> Runs;
+	for (const FIntPoint& Resolution : Resolutions)
+	{
+		for (const int32 Seed : Seeds)
+		{
+			FString FirstChecksums;
+			for (int32 Repeat = 0; Repeat < Repeats; ++Repeat)
+			{
+				TSharedPtr<FJsonObject> Run = RunBenchmark(SourcePreset, Resolution, Seed, Repeat);
+				if (Run->HasField(TEXT("Error")))
+				{
+					bSucceeded = false;
+					Runs.Add(MakeShared<FJsonValueObject>(Run));
+					break;
+				}
+
+				const TSharedPtr<FJsonObject>& Checksums = Run->GetObjectField(TEXT("Checksums"));
+				const FString RunChecksums = Checksums->GetStringField(TEXT("HeightMap")) + Checksums->GetStringField(TEXT("TemperatureMap"))
+					+ Checksums->GetStringField(TEXT("HumidityMap"));
+				if (Repeat == 0)
+				{
+					FirstChecksums = RunChecksums;
+				}
+				const bool bDeterministic = RunChecksums == FirstChecksums;
+				Run->SetBoolField(TEXT("MatchesFirstRepeat"), bDeterministic);
+				if (!bDeterministic)
+				{
+					UE_LOG(LogOCGModule, Error, TEXT("%dx%d seed %d repeat %d produced different maps than the first repeat"), Resolution.X, Resolution.Y, Seed, Repeat);
+					bSucceeded = false;
+				}
+
+				Runs.Add(MakeShared<FJsonValueObject>(Run));
+			}
+		}
+	}
+	Root->SetArrayField(TEXT("Runs"), Runs);
+
+	FString JsonText;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonText);
+	FJsonSerializer::Serialize(Root, Writer);
+	if (!FFileHelper::SaveStringToFile(JsonText, *OutputPath))
+	{
+		UE_LOG(LogOCGModule, Error, TEXT("Failed to write benchmark result to %s"), *OutputPath);
+		return 1;
+	}
+	UE_LOG(LogOCGModule, Display, TEXT("Benchmark result written to %s"), *OutputPath);
+
+	return bSucceeded ? 0 : 1;
+}
+
+bool UOCGBenchmarkCommandlet::ParseResolutions(const FString& InText, TArray<FIntPoint>& OutResolutions)
+{
+	TArray<FString> Entries;
+	InText.ParseIntoArray(Entries, TEXT(","));
+	for (const FString& Entry : Entries)
+	{
+		FString XText;
+		FString YText;
+		if (!Entry.Split(TEXT("x"), &XText, &YText, ESearchCase::IgnoreCase) || !XText.IsNumeric() || !YText.IsNumeric())
+			return false;
+
+		const FIntPoint Resolution(FCString::Atoi(*XText), FCString::Atoi(*YText));
+		if (Resolution.X <= 0 || Resolution.Y <= 0)
+			return false;
+		OutResolutions.Add(Resolution);
+	}
+	return !OutResolutions.IsEmpty();
+}
+
+bool UOCGBenchmarkCommandlet::ParseSeeds(const FString& InText, TArray<int32>& OutSeeds)
+{
+	TArray<FString> Entries;
+	InText.ParseIntoArray(Entries, TEXT(","));
+	for (const FString& Entry : Entries)
+	{
+		if (!Entry.IsNumeric())
+			return false;
+		OutSeeds.Add(FCString::Atoi(*Entry));
+	}
+	return !OutSeeds.IsEmpty();
+}
+
+TSharedPtr<FJsonObject> UOCGBenchmarkCommandlet::RunBenchmark(const UMapPreset* SourcePreset, const FIntPoint& Resolution, const int32 Seed,
+	const int32 Repeat) const
+{
+	TSharedPtr<FJsonObject> Run = MakeShared<FJsonObject>();
+	Run->SetStringField(TEXT("Resolution"), FString::Printf(TEXT("%dx%d"), Resolution.X, Resolution.Y));
+	Run->SetNumberField(TEXT("Seed"), Seed);
+	Run->SetNumberField(TEXT("Repeat"), Repeat);
+
+	// Work on a transient copy so the preset asset is never dirtied
+	UMapPreset* MapPreset = DuplicateObject<UMapPreset>(SourcePreset, GetTransientPackage());
+	MapPreset->MapResolution = Resolution;
+	MapPreset->Seed = Seed;
+	MapPreset->bExportMapTextures = false;
+
+	FText ErrorText;
+	if (!UOCGMapGenerateComponent::CheckMemoryBudget(MapPreset, ErrorText))
+	{
+		Run->SetStringField(TEXT("Error"), ErrorText.ToString());
+		return Run;
+	}
+
+	UOCGMapGenerateComponent* MapGenerator = NewObject<UOCGMapGenerateComponent>(GetTransientPackage());
+	const double StartTime = FPlatformTime::Seconds();
+	// Every run has to generate, a map cache hit would neither be timed nor checked for determinism
+	MapGenerator->GenerateMapsForPreset(MapPreset, false);
+	const double TotalMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	Run->SetNumberField(TEXT("TotalMilliseconds"), TotalMilliseconds);
+
+	TArray<TSharedPtr<FJsonValue>> Stages;
+	for (const FOCGStageStats& StageStats : FOCGGenerationStats::Get().GetStages())
+	{
+		TSharedRef<FJsonObject> Stage = MakeShared<FJsonObject>();
+		Stage->SetStringField(TEXT("Name"), StageStats.StageName);
+		Stage->SetNumberField(TEXT("Milliseconds"), StageStats.Milliseconds);
+		Stage->SetNumberField(TEXT("ScratchPeakBytes"), StageStats.ScratchPeakBytes);
+		Stages.Add(MakeShared<FJsonValueObject>(Stage));
+	}
+	Run->SetArrayField(TEXT("Stages"), Stages);
+
+	TSharedRef<FJsonObject> Checksums = MakeShared<FJsonObject>();
+	Checksums->SetStringField(TEXT("HeightMap"), GetMapChecksum(MapPreset->HeightMapData));
+	Checksums->SetStringField(TEXT("TemperatureMap"), GetMapChecksum(MapPreset->TemperatureMapData));
+	Checksums->SetStringField(TEXT("HumidityMap"), GetMapChecksum(MapPreset->HumidityMapData));
+	Run->SetObjectField(TEXT("Checksums"), Checksums);
+
+	UE_LOG(LogOCGModule, Display, TEXT("%dx%d seed %d repeat %d: %.2f ms"), Resolution.X, Resolution.Y, Seed, Repeat, TotalMilliseconds);
+	return Run;
+}
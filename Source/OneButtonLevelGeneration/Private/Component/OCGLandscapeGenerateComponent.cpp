@@ -14,6 +14,7 @@
 
 #include "Components/BoxComponent.h"
 #include "UObject/ConstructorHelpers.h"
+#include "Utils/OCGGenerationStats.h"
 #include "Utils/OCGLandscapeUtil.h"
 
 #if WITH_EDITOR
@@ -148,6 +149,8 @@ void UOCGLandscapeGenerateComponent::GenerateLandscape(UWorld* World)
 	if (MapPreset == nullptr)
 		return;
 
+	OCG_SCOPED_GENERATION_STAGE(TEXT("Generating Landscape"), static_cast<int64>(MapPreset->MapResolution.X) * MapPreset->MapResolution.Y);
+
     if (!World || World->IsGameWorld())
     {
         UE_LOG(LogOCGModule, Error, TEXT("유효한 에디터 월드가 아닙니다."));
@@ -305,7 +308,11 @@ void UOCGLandscapeGenerateComponent::GenerateLandscape(UWorld* World)
     FGuid LayerGuid = FGuid();
     HeightmapDataPerLayer.Add(LayerGuid, LevelGenerator->GetHeightMapData());
 	
-    const TMap<FGuid, TArray<FLandscapeImportLayerInfo>> MaterialLayerDataPerLayer = OCGLandscapeUtil::PrepareLandscapeLayerData(TargetLandscape, LevelGenerator, MapPreset);
+    TMap<FGuid, TArray<FLandscapeImportLayerInfo>> MaterialLayerDataPerLayer;
+	{
+		OCG_SCOPED_GENERATION_STAGE(TEXT("Preparing Landscape Layer Data"), static_cast<int64>(MapResolution.X) * MapResolution.Y);
+		MaterialLayerDataPerLayer = OCGLandscapeUtil::PrepareLandscapeLayerData(TargetLandscape, LevelGenerator, MapPreset);
+	}
 	
 // Set the basic properties of the landscape// Set the basic properties of the landscape
     float OffsetX = (-MapPreset->MapResolution.X / 2.f) * 100.f * MapPreset->LandscapeScale;
@@ -315,6 +322,7 @@ void UOCGLandscapeGenerateComponent::GenerateLandscape(UWorld* World)
 
 	if (IsCreateNewLandscape)
 	{
+		OCG_SCOPED_GENERATION_STAGE(TEXT("Importing New Landscape"), static_cast<int64>(MapResolution.X) * MapResolution.Y);
 		TargetLandscape->Import(
 			FGuid::NewGuid(),
 			0, 0,
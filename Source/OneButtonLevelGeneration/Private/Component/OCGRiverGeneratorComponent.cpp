@@ -14,9 +14,14 @@
 #include "Components/SplineComponent.h"
 #include "Data/MapData.h"
 #include "Data/MapPreset.h"
+#include "Utils/OCGGenerationStats.h"
 #include "Kismet/GameplayStatics.h"
 #include "Utils/OCGLandscapeUtil.h"
 #include "Utils/OCGMaterialEditTool.h"
+#include "Utils/OCGParallelUtils.h"
+#include "Utils/OCGPathSimplify.h"
+#include "Utils/OCGDrainageNetwork.h"
+#include "Utils/OCGRiverPathfinder.h"
 
 #if WITH_EDITOR
 #include "Landscape.h"
@@ -26,6 +31,17 @@
 #endif
 
 
+namespace
+{
+	// A drainage channel starts where it drains this fraction of the map
+	constexpr int32 ChannelAreaDivisor = 2048;
+	constexpr int32 MinChannelAccumulation = 16;
+	// Shorter channels are left out instead of becoming stub rivers
+	constexpr int32 MinChannelLength = 16;
+	// Candidates tried per river source before settling for the one farthest from the other sources
+	constexpr int32 RiverSourceSampleAttempts = 30;
+}
+
 UOCGRiverGenerateComponent::UOCGRiverGenerateComponent()
 {
 
@@ -34,6 +50,7 @@ UOCGRiverGenerateComponent::UOCGRiverGenerateComponent()
 void UOCGRiverGenerateComponent::GenerateRiver(UWorld* InWorld, ALandscape* InLandscape, bool bForceCleanUpPrevWaterWeightMap)
 {
 #if WITH_EDITOR
+	OCG_SCOPED_GENERATION_STAGE(TEXT("Generating River"), 0);
 	if (InWorld == nullptr)
 	{
 		return;
@@ -67,11 +84,6 @@ void UOCGRiverGenerateComponent::GenerateRiver(UWorld* InWorld, ALandscape* InLa
 		return;
 	}
 	
-	if (MapPreset && bIsRiverExists && CurrentRiverSeed == MapPreset->RiverSeed)
-	{
-		return;
-	}
-	
 	MapPreset = GetLevelGenerator()->GetMapPreset();
 
 	
@@ -99,8 +111,6 @@ void UOCGRiverGenerateComponent::GenerateRiver(UWorld* InWorld, ALandscape* InLa
 		}
 	}
 
-	CurrentRiverSeed = MapPreset ? MapPreset->RiverSeed : 0;
-
 	const TArray<uint16>& HeightMapData = MapPreset->HeightMapData;
 	if (HeightMapData.Num() < MapPreset->MapResolution.X * MapPreset->MapResolution.Y)
 	{
@@ -108,143 +118,134 @@ void UOCGRiverGenerateComponent::GenerateRiver(UWorld* InWorld, ALandscape* InLa
 		return;
 	}
 
-	CacheRiverStartPoints();
-
 	FVector LandscapeOrigin = InLandscape->GetActorLocation();
 	FVector LandscapeExtent = InLandscape->GetLoadedBounds().GetExtent();
-	// Generate River Spline
-	for (int RiverCount = 0; RiverCount < MapPreset->RiverCount; RiverCount++)
-	{
-		FIntPoint MapResolution = MapPreset->MapResolution;
-		FIntPoint StartPoint = GetRandomStartPoint(RiverCount);
 
-		TSet<FIntPoint> VisitedNodes;
-		TMap<FIntPoint, FIntPoint> CameFrom;
-		TMap<FIntPoint, float> CostSoFar;
+	SeaHeight = MapPreset->MinHeight + 
+		(MapPreset->MaxHeight - MapPreset->MinHeight) * MapPreset->SeaLevel - 5;
 
-		TArray<TTuple<FIntPoint, float>> Frontier;
-		Frontier.Add({StartPoint, 0.f});
-		
-		CameFrom.Add(StartPoint, StartPoint);
-		CostSoFar.Add(StartPoint, 0.f);
+	// Heights and distance to the sea are shared by every river
+	UpdateRiverCostField(LandscapeExtent);
+	const FOCGRiverCostField& CostField = RiverCostField;
+	if (!CostField.HasSea())
+	{
+		UE_LOG(LogOCGModule, Warning, TEXT("River generation: no landscape point is below the sea height, rivers have nowhere to flow."));
+	}
+
+	// Map pixels of every river from its source to where it flows into the sea or into another river
+	TArray<TArray<FIntPoint>> RiverPixelPaths;
+	if (MapPreset->RiverPlacement == EOCGRiverPlacement::DrainageNetwork)
+	{
+		FOCGDrainageNetwork DrainageNetwork;
+		DrainageNetwork.Build(CostField.Heights, CostField.Resolution, CostField.SeaHeight);
+		const int32 MinAccumulation = FMath::Max(CostField.Num() / ChannelAreaDivisor, MinChannelAccumulation);
+		DrainageNetwork.ExtractChannels(MapPreset->RiverCount, MinAccumulation, MinChannelLength, RiverPixelPaths);
+	}
+	else
+	{
+		UpdateRiverStartIndex();
 
-		FIntPoint GoalPoint = FIntPoint(-1, -1);
+		TArray<FIntPoint> StartPoints;
+		for (int RiverCount = 0; RiverCount < MapPreset->RiverCount; RiverCount++)
+		{
+			StartPoints.Add(GetRandomStartPoint(RiverCount));
+		}
 
-		while (Frontier.Num() > 0)
+		// Searches only read the cost field, every band of rivers routes with its own pathfinder arrays.
+		// Each river keeps its slot, so the result does not depend on the number of threads
+		TArray<TArray<FIntPoint>> SearchedPaths;
+		SearchedPaths.SetNum(StartPoints.Num());
+		FOCGParallelUtils::ParallelForRows(StartPoints.Num(), MapPreset->MaxGenerationThreads, [&](const int32 StartRiver, const int32 EndRiver)
 		{
-			int32 BestIndex = 0;
-			for (int32 i = 1; i < Frontier.Num(); ++i)
+			FOCGRiverPathfinder Pathfinder;
+			for (int32 RiverIndex = StartRiver; RiverIndex < EndRiver; ++RiverIndex)
 			{
-				if (Frontier[i].Get<1>() < Frontier[BestIndex].Get<1>())
-				{
-					BestIndex = i;
-				}
+				Pathfinder.FindPath(CostField, StartPoints[RiverIndex], SearchedPaths[RiverIndex]);
 			}
+		});
 
-			TTuple<FIntPoint, float> BestNode = Frontier[BestIndex];
-			Frontier.RemoveAt(BestIndex);
-
-			FIntPoint Current = BestNode.Get<0>();
-			
-			if (GetLandscapePointWorldPosition(Current, LandscapeOrigin, LandscapeExtent).Z < SeaHeight)
+		for (TArray<FIntPoint>& PathPoints : SearchedPaths)
+		{
+			if (!PathPoints.IsEmpty())
 			{
-				GoalPoint = Current;
-				break;
-			}
-			
-			for (int dx = -1; dx <= 1; ++dx)
-			{
-				for (int dy = -1; dy <= 1; ++dy)
-				{
-					if (dx == 0 && dy == 0) continue;
-
-					FIntPoint Neighbor = FIntPoint(Current.X + dx, Current.Y + dy);
-					if (Neighbor.X < 0 || Neighbor.X >= MapResolution.X || Neighbor.Y < 0 || Neighbor.Y >= MapResolution.Y) continue;
-					
-					float NewCost = CostSoFar[Current] + 1; 
-            
-					if (!CostSoFar.Contains(Neighbor) || NewCost < CostSoFar[Neighbor])
-					{
-						CostSoFar.Add(Neighbor, NewCost);
-						int32 nIdx = Neighbor.Y * MapResolution.X + Neighbor.X;
-						float Heuristic = HeightMapData[nIdx] - SeaHeight; 
-						float NewPriority = NewCost + Heuristic;
-						//float NewPriority = HeightMapData[nIdx];
-						Frontier.Add({Neighbor, NewPriority});
-						CameFrom.Add(Neighbor, Current);
-					}
-				}
+				RiverPixelPaths.Add(MoveTemp(PathPoints));
 			}
 		}
-		
-		if (GoalPoint != FIntPoint(-1, -1))
+	}
+	UE_LOG(LogOCGModule, Log, TEXT("Routed %d of %d rivers"), RiverPixelPaths.Num(), MapPreset->RiverCount);
+
+	// Every river goes into the same water zone, which has to cover the whole landscape
+	TArray<AActor*> FoundActors;
+	UGameplayStatics::GetAllActorsOfClass(InWorld, AWaterZone::StaticClass(), FoundActors);
+
+	FVector LandscapeSize = InLandscape->GetLoadedBounds().GetSize();
+	for (AActor* Actor : FoundActors)
+	{
+		if (AWaterZone* WaterZone = Cast<AWaterZone>(Actor))
 		{
-			TArray<FVector> RiverPath;
-			FIntPoint Current = GoalPoint;
-			while (Current != StartPoint)
-			{
-				RiverPath.Add(GetLandscapePointWorldPosition(Current, LandscapeOrigin, LandscapeExtent));
-				Current = CameFrom[Current];
-			}
-			RiverPath.Add(GetLandscapePointWorldPosition(StartPoint, LandscapeOrigin, LandscapeExtent));
-			Algo::Reverse(RiverPath);
-			
-			TArray<FVector> SimplifiedRiverPath;
-			SimplifyPathRDP(RiverPath, SimplifiedRiverPath, MapPreset->RiverSplineSimplifyEpsilon);
+			// Set the ZoneExtent property of the WaterZone to the landscape's X and Y size.
+			WaterZone->SetZoneExtent(FVector2D(LandscapeSize.X, LandscapeSize.Y));
+		}
+	}
 
-			// Generate AWaterBodyRiver Actor
-			FVector WaterBodyPos = GetLandscapePointWorldPosition(StartPoint, LandscapeOrigin, LandscapeExtent);
-			FTransform WaterBodyTransform = FTransform(WaterBodyPos);
+	if (GetWorld()->IsEditorWorld() && !RiverPixelPaths.IsEmpty())
+	{
+		Modify();
+		if (AActor* Owner = GetOwner())
+		{
+			Owner->Modify();
+			(void)Owner->MarkPackageDirty();
+		}
+	}
 
-			// Spawn Water Body Actor
-			AWaterBodyRiver* WaterBodyRiver = InWorld->SpawnActor<AWaterBodyRiver>(AWaterBodyRiver::StaticClass(), WaterBodyTransform);
+	// Generate River Spline
+	for (const TArray<FIntPoint>& PathPoints : RiverPixelPaths)
+	{
+		const FIntPoint StartPoint = PathPoints[0];
+		TArray<FVector> RiverPath;
+		RiverPath.Reserve(PathPoints.Num());
+		for (const FIntPoint& PathPoint : PathPoints)
+		{
+			RiverPath.Add(GetLandscapePointWorldPosition(PathPoint, LandscapeOrigin, LandscapeExtent));
+		}
+		
+		TArray<FVector> SimplifiedRiverPath;
+		SimplifyRiverPath(RiverPath, SimplifiedRiverPath);
 
-			TArray<AActor*> FoundActors;
-			UGameplayStatics::GetAllActorsOfClass(InWorld, AWaterZone::StaticClass(), FoundActors);
+		// Generate AWaterBodyRiver Actor
+		FVector WaterBodyPos = GetLandscapePointWorldPosition(StartPoint, LandscapeOrigin, LandscapeExtent);
+		FTransform WaterBodyTransform = FTransform(WaterBodyPos);
 
-			FVector LandscapeSize = InLandscape->GetLoadedBounds().GetSize();
-			for (AActor* Actor : FoundActors)
-			{
-				if (AWaterZone* WaterZone = Cast<AWaterZone>(Actor))
-				{
-					// 2. Set the ZoneExtent property of the WaterZone to the landscape's X and Y size.
-					WaterZone->SetZoneExtent(FVector2D(LandscapeSize.X, LandscapeSize.Y));
-				}
-			}
-			SetDefaultRiverProperties(WaterBodyRiver, SimplifiedRiverPath);
-			AddRiverProperties(WaterBodyRiver, SimplifiedRiverPath);
-			
-			if (GetWorld()->IsEditorWorld())
-			{
-				Modify();
-				if (AActor* Owner = GetOwner())
-				{
-					Owner->Modify();
-					(void)Owner->MarkPackageDirty();
-				}
-			}
+		// Spawn Water Body Actor
+		AWaterBodyRiver* WaterBodyRiver = InWorld->SpawnActor<AWaterBodyRiver>(AWaterBodyRiver::StaticClass(), WaterBodyTransform);
 
-			WaterBodyRiver->Modify();
-			
-			GeneratedRivers.Add(WaterBodyRiver);
-			CachedRivers.Add(TSoftObjectPtr<AWaterBodyRiver>(WaterBodyRiver));
+		SetDefaultRiverProperties(WaterBodyRiver, SimplifiedRiverPath);
+		AddRiverProperties(WaterBodyRiver, SimplifiedRiverPath);
+
+		WaterBodyRiver->Modify();
+		
+		GeneratedRivers.Add(WaterBodyRiver);
+		CachedRivers.Add(TSoftObjectPtr<AWaterBodyRiver>(WaterBodyRiver));
+	}
 
+	// One edit layer update for all rivers, the water brushes of every river are rendered in the same pass
+	if (!RiverPixelPaths.IsEmpty())
+	{
 #if ENGINE_MINOR_VERSION > 5
-			FGuid WaterLayerGuid = InLandscape->GetEditLayerConst(1)->GetGuid();
+		FGuid WaterLayerGuid = InLandscape->GetEditLayerConst(1)->GetGuid();
 #else
-			FGuid WaterLayerGuid = InLandscape->GetLayerConst(1)->Guid;
+		FGuid WaterLayerGuid = InLandscape->GetLayerConst(1)->Guid;
 #endif
 
-			FScopedSetLandscapeEditingLayer Scope(InLandscape, WaterLayerGuid, [&]
-			{
-				check(InLandscape);
-				InLandscape->RequestLayersContentUpdate(ELandscapeLayerUpdateMode::Update_Heightmap_All);
-			});
+		FScopedSetLandscapeEditingLayer Scope(InLandscape, WaterLayerGuid, [&]
+		{
+			check(InLandscape);
+			InLandscape->RequestLayersContentUpdate(ELandscapeLayerUpdateMode::Update_Heightmap_All);
+		});
 
-			if (ULandscapeInfo* LandscapeInfo = InLandscape->GetLandscapeInfo())
-			{
-				LandscapeInfo->ForceLayersFullUpdate();
-			}
+		if (ULandscapeInfo* LandscapeInfo = InLandscape->GetLandscapeInfo())
+		{
+			LandscapeInfo->ForceLayersFullUpdate();
 		}
 	}
 
@@ -601,6 +602,39 @@ FVector UOCGRiverGenerateComponent::GetLandscapePointWorldPosition(const FIntPoi
 	return WorldLocation;
 }
 
+void UOCGRiverGenerateComponent::UpdateRiverCostField(const FVector& LandscapeExtent)
+{
+	const FIntPoint MapResolution = MapPreset->MapResolution;
+	const float PixelSize = 2.f * LandscapeExtent.X / FMath::Max(MapResolution.X - 1, 1);
+	const float LandscapeZ = TargetLandscape->GetActorLocation().Z;
+	const float ScaleZ = TargetLandscape->GetActorScale3D().Z;
+	const FVector4f Params(SeaHeight, PixelSize, LandscapeZ, ScaleZ);
+	if (RiverCostFieldPreset.Get() == MapPreset && RiverCostFieldRevision == MapPreset->HeightMapRevision
+		&& RiverCostFieldParams == Params && RiverCostField.Resolution == MapResolution)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UOCGRiverGenerateComponent::UpdateRiverCostField);
+
+	// World heights as the landscape places the height map, ActorZ + (Value - 32768) / 128 * ScaleZ
+	const TArray<uint16>& HeightMapData = MapPreset->HeightMapData;
+	TArray<float> Heights;
+	Heights.SetNumUninitialized(MapResolution.X * MapResolution.Y);
+	FOCGParallelUtils::ParallelForRows(MapResolution.Y, MapPreset->MaxGenerationThreads, [&](const int32 StartY, const int32 EndY)
+	{
+		for (int32 i = StartY * MapResolution.X; i < EndY * MapResolution.X; ++i)
+		{
+			Heights[i] = LandscapeZ + (HeightMapData[i] - 32768.f) / 128.f * ScaleZ;
+		}
+	});
+
+	RiverCostField.Build(MoveTemp(Heights), MapResolution, SeaHeight, PixelSize, MapPreset->MaxGenerationThreads);
+	RiverCostFieldPreset = MapPreset;
+	RiverCostFieldRevision = MapPreset->HeightMapRevision;
+	RiverCostFieldParams = Params;
+}
+
 void UOCGRiverGenerateComponent::SetDefaultRiverProperties(AWaterBodyRiver* InRiverActor, const TArray<FVector>& InRiverPath)
 {
 	UWaterBodyComponent* WaterBodyComponent = CastChecked<AWaterBody>(InRiverActor)->GetWaterBodyComponent();
@@ -666,99 +700,68 @@ FIntPoint UOCGRiverGenerateComponent::GetRandomStartPoint(int RiverIndex)
 
 	// 강마다 시드 고유화(재현성 보장)
 	FRandomStream Stream(MapPreset->RiverSeed + RiverIndex * 9973); // 9973은 큰 소수
+
+	// Spread the sources so that every river gets a share of the map, roughly one source per disc of this radius
+	const float MinSpacing = FMath::Max(MapPreset->MapResolution.X, MapPreset->MapResolution.Y)
+		/ (2.f * FMath::Sqrt(static_cast<float>(FMath::Max(MapPreset->RiverCount, 1))));
     
 	FIntPoint StartPoint;
-	if (CachedRiverStartPoints.Num() > 0)
-	{
-		StartPoint = CachedRiverStartPoints[Stream.RandRange(0, CachedRiverStartPoints.Num() - 1)];
-	}
-	else
+	if (!RiverStartIndex.SampleAtOrAbove(RiverSourceMinHeight, Stream, MinSpacing, UsedRiverStartPoints, RiverSourceSampleAttempts, StartPoint))
 	{
 		StartPoint = FIntPoint(MapPreset->MapResolution.X / 2, MapPreset->MapResolution.Y - 1);
 	}
+	UsedRiverStartPoints.Add(StartPoint);
 
 	return StartPoint;
 }
 
-void UOCGRiverGenerateComponent::SimplifyPathRDP(const TArray<FVector>& InPoints, TArray<FVector>& OutPoints,
-	float Epsilon)
+void UOCGRiverGenerateComponent::SimplifyRiverPath(const TArray<FVector>& InPoints, TArray<FVector>& OutPoints) const
 {
-	if (InPoints.Num() < 3)
-	{
-		OutPoints = InPoints;
-		return;
-	}
-
-	float dmax = 0.0f;
-	int32 index = 0;
-	int32 end = InPoints.Num() - 1;
-
-	for (int32 i = 1; i < end; i++)
+	const float Epsilon = MapPreset->RiverSplineSimplifyEpsilon;
+	TBitArray<> KeptPoints;
+	if (MapPreset->RiverSplineSimplification == EOCGRiverSimplification::Visvalingam)
 	{
-		float d = FMath::PointDistToSegment(InPoints[i], InPoints[0], InPoints[end]);
-		if (d > dmax)
-		{
-			index = i;
-			dmax = d;
-		}
-	}
-
-	if (dmax > Epsilon)
-	{
-		TArray<FVector> RecResults1;
-		TArray<FVector> RecResults2;
-        
-		TArray<FVector> FirstHalf(InPoints.GetData(), index + 1);
-		SimplifyPathRDP(FirstHalf, RecResults1, Epsilon);
-
-		TArray<FVector> SecondHalf(InPoints.GetData() + index, InPoints.Num() - index);
-		SimplifyPathRDP(SecondHalf, RecResults2, Epsilon);
-
-		OutPoints.Append(RecResults1.GetData(), RecResults1.Num() - 1);
-		OutPoints.Append(RecResults2);
+		OCGPathSimplify::Visvalingam(InPoints, 0.5f * Epsilon * Epsilon, KeptPoints);
 	}
 	else
 	{
-		OutPoints.Add(InPoints[0]);
-		OutPoints.Add(InPoints[end]);
+		OCGPathSimplify::RamerDouglasPeucker(InPoints, Epsilon, KeptPoints);
 	}
+	OCGPathSimplify::GatherKept(InPoints, KeptPoints, OutPoints);
 }
 
-void UOCGRiverGenerateComponent::CacheRiverStartPoints()
+void UOCGRiverGenerateComponent::UpdateRiverStartIndex()
 {
-	if (!TargetLandscape || !GetLevelGenerator() || !GetLevelGenerator()->GetMapPreset())
+	TRACE_CPUPROFILER_EVENT_SCOPE(UOCGRiverGenerateComponent::UpdateRiverStartIndex);
+
+	UsedRiverStartPoints.Reset();
+	if (!TargetLandscape || !MapPreset)
 	{
-		UE_LOG(LogOCGModule, Error, TEXT("TargetLandscape or LevelGenerator is not set. Cannot cache river start points."));
+		UE_LOG(LogOCGModule, Error, TEXT("TargetLandscape or MapPreset is not set. Cannot cache river start points."));
+		RiverStartIndex.Reset();
 		return;
 	}
-	
-	CachedRiverStartPoints.Empty();
-    
-	// Ensure the multiplier is within a reasonable range
-	float StartPointThresholdMultiplier = FMath::Clamp(MapPreset->RiverSourceElevationRatio, 0.0f, 1.0f);
-	float MaxHeight = MapPreset->MaxHeight;
-	float MinHeight = MapPreset->MinHeight;
-
-	
-	SeaHeight = MinHeight + 
-		(MaxHeight - MinHeight) * MapPreset->SeaLevel - 5;
-    
-	uint16 HighThreshold = SeaHeight + (MaxHeight - SeaHeight) * StartPointThresholdMultiplier;
-	UE_LOG(LogOCGModule, Log, TEXT("High Threshold for River Start Point: %d"), HighThreshold);
 
-	FVector LandscapeOrigin = TargetLandscape->GetLoadedBounds().GetCenter();
-	FVector LandscapeExtent = TargetLandscape->GetLoadedBounds().GetExtent();
-	for (int32 y = 0; y < MapPreset->MapResolution.Y; ++y)
+	if (RiverStartIndexPreset.Get() != MapPreset || RiverStartIndexRevision != MapPreset->HeightMapRevision
+		|| RiverStartIndex.GetResolution() != MapPreset->MapResolution)
 	{
-		for (int32 x = 0; x < MapPreset->MapResolution.X; ++x)
-		{
-			FVector WorldLocation = GetLandscapePointWorldPosition(FIntPoint(x, y), LandscapeOrigin, LandscapeExtent);
-			if (WorldLocation.Z >= HighThreshold)
-			{
-				CachedRiverStartPoints.Add(FIntPoint(x, y));
-			}
-		}
+		RiverStartIndex.Build(MapPreset->HeightMapData, MapPreset->MapResolution);
+		RiverStartIndexPreset = MapPreset;
+		RiverStartIndexRevision = MapPreset->HeightMapRevision;
 	}
+    
+	// Ensure the multiplier is within a reasonable range
+	float StartPointThresholdMultiplier = FMath::Clamp(MapPreset->RiverSourceElevationRatio, 0.0f, 1.0f);
+	float HighThreshold = SeaHeight + (MapPreset->MaxHeight - SeaHeight) * StartPointThresholdMultiplier;
+
+	// The landscape places a height map value at ActorZ + (Value - 32768) / 128 * ScaleZ, invert that to compare raw values
+	const float ScaleZ = TargetLandscape->GetActorScale3D().Z;
+	const float ThresholdValue = FMath::IsNearlyZero(ScaleZ)
+		? 32768.f
+		: (HighThreshold - TargetLandscape->GetActorLocation().Z) * 128.f / ScaleZ + 32768.f;
+	RiverSourceMinHeight = static_cast<uint16>(FMath::Clamp(FMath::CeilToInt32(ThresholdValue), 0, static_cast<int32>(TNumericLimits<uint16>::Max())));
+	UE_LOG(LogOCGModule, Log, TEXT("High Threshold for River Start Point: %.1f (height map value %d, %d candidates)"),
+		HighThreshold, RiverSourceMinHeight, RiverStartIndex.GetPixelsAtOrAbove(RiverSourceMinHeight).Num());
 }
 
 
@@ -8,6 +8,7 @@
 #include "Components/BoxComponent.h"
 #include "Data/MapPreset.h"
 #include "PCG/OCGLandscapeVolume.h"
+#include "Utils/OCGGenerationStats.h"
 #include "Utils/OCGUtils.h"
 
 
@@ -26,6 +27,7 @@ void UOCGTerrainGenerateComponent::GenerateTerrainInEditor()
 void UOCGTerrainGenerateComponent::GenerateTerrain(UWorld* World)
 {
 #if WITH_EDITOR
+	OCG_SCOPED_GENERATION_STAGE(TEXT("Generating Terrain"), 0);
 	const AOCGLevelGenerator* LevelGenerator = GetLevelGenerator();
 	if (!LevelGenerator || !LevelGenerator->GetMapPreset())
 	{
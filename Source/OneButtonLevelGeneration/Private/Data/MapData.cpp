@@ -208,7 +208,7 @@ UTexture2D* OCGMapDataUtils::ImportTextureFromPNG(const FString& FileName)
 #endif
 }
 
-bool OCGMapDataUtils::ExportMap(const TArray<uint8>& InMap, const FIntPoint& Resolution, const FString& FileName)
+bool OCGMapDataUtils::ExportMap(TConstArrayView<uint8> InMap, const FIntPoint& Resolution, const FString& FileName)
 {
 #if WITH_EDITOR
 	// Create directory and full path for the map file
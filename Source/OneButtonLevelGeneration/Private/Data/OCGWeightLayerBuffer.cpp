@@ -0,0 +1,54 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Data/OCGWeightLayerBuffer.h"
+
+void FOCGWeightLayerBuffer::Init(const int32 InNumLayers, const FIntPoint& InResolution)
+{
+	NumLayers = FMath::Max(InNumLayers, 0);
+	Resolution = InResolution;
+	// Reset keeps the allocation when the size does not change between generations
+	Data.Reset();
+	Data.SetNumZeroed(static_cast<int64>(NumLayers) * GetNumPixels());
+}
+
+void FOCGWeightLayerBuffer::Empty()
+{
+	Data.Empty();
+	NumLayers = 0;
+	Resolution = FIntPoint::ZeroValue;
+}
+
+void FOCGWeightLayerBuffer::Serialize(FArchive& Ar)
+{
+	Ar << NumLayers;
+	Ar << Resolution;
+
+	// Loaded buffers come from cache files that may be damaged, the size is checked against the layout and the bytes
+	// left before allocating
+	int64 NumBytes = Data.Num();
+	Ar << NumBytes;
+	if (Ar.IsLoading())
+	{
+		const bool bFitsInArchive = NumLayers >= 0 && Resolution.X >= 0 && Resolution.Y >= 0
+			&& NumBytes == static_cast<int64>(NumLayers) * Resolution.X * Resolution.Y
+			&& NumBytes <= Ar.TotalSize() - Ar.Tell();
+		if (Ar.IsError() || !bFitsInArchive)
+		{
+			Ar.SetError();
+			Empty();
+			return;
+		}
+		Data.SetNumUninitialized(NumBytes);
+	}
+	Ar.Serialize(Data.GetData(), NumBytes);
+
+	if (Ar.IsLoading() && Ar.IsError())
+	{
+		Empty();
+	}
+}
+
+FName FOCGWeightLayerBuffer::GetDefaultLayerName(const int32 LayerIndex)
+{
+	return FName(*FString::Printf(TEXT("Layer%d"), LayerIndex));
+}
@@ -14,6 +14,7 @@
 #include "Utils/OCGLandscapeUtil.h"
 #include "Utils/OCGUtils.h"
 #include "Widgets/Layout/SBox.h"
+#include "Widgets/Notifications/SProgressBar.h"
 #include "Widgets/Text/STextBlock.h"
 
 void SOCGWidget::Construct([[maybe_unused]] const FArguments& InArgs)
@@ -85,6 +86,39 @@ void SOCGWidget::Construct([[maybe_unused]] const FArguments& InArgs)
             ]
         ]
         
+        // Map generation progress and Cancel Button, shown while maps are generated in the background
+        + SVerticalBox::Slot()
+        .AutoHeight().Padding(5)
+        [
+            SNew(SHorizontalBox)
+            .Visibility(this, &SOCGWidget::GetMapGenerationVisibility)
+            + SHorizontalBox::Slot()
+            .FillWidth(1.0f).VAlign(VAlign_Center)
+            [
+                SNew(SVerticalBox)
+                + SVerticalBox::Slot()
+                .AutoHeight()
+                [
+                    SNew(STextBlock)
+                    .Text(this, &SOCGWidget::GetMapGenerationStageText)
+                ]
+                + SVerticalBox::Slot()
+                .AutoHeight().Padding(0, 2, 0, 0)
+                [
+                    SNew(SProgressBar)
+                    .Percent(this, &SOCGWidget::GetMapGenerationProgress)
+                ]
+            ]
+
+            + SHorizontalBox::Slot()
+            .AutoWidth().Padding(5, 0, 0, 0).VAlign(VAlign_Center)
+            [
+                SNew(SButton)
+                .Text(FText::FromString(TEXT("Cancel")))
+                .OnClicked(this, &SOCGWidget::OnCancelMapGenerationClicked)
+            ]
+        ]
+        
         //Force Generate PCG Button
         + SVerticalBox::Slot()
         .AutoHeight().Padding(5)
@@ -204,7 +238,7 @@ FReply SOCGWidget::OnPreviewMapClicked()
 {
     if (LevelGeneratorActor.IsValid() && MapPreset.IsValid())
     {
-        LevelGeneratorActor->PreviewMaps();
+        LevelGeneratorActor->PreviewMapsAsync();
     }
     return FReply::Handled();
 }
@@ -213,7 +247,7 @@ FReply SOCGWidget::OnGenerateLevelClicked()
 {
     if (LevelGeneratorActor.IsValid() && LevelGeneratorActor->GetMapPreset())
     {
-        LevelGeneratorActor->OnClickGenerate(GEditor->GetEditorWorldContext().World());
+        LevelGeneratorActor->GenerateAsync(GEditor->GetEditorWorldContext().World());
     }
     return FReply::Handled();
 }
@@ -278,13 +312,46 @@ void SOCGWidget::OnLevelActorDeleted(AActor* InActor)
 
 bool SOCGWidget::IsPreviewMapEnabled() const
 {
-    return MapPreset.IsValid();
+    return MapPreset.IsValid() && !IsGeneratingMaps();
 }
 
 bool SOCGWidget::IsGenerateEnabled() const
 {
     // Enable button only if both actor and preset are valid
-    return LevelGeneratorActor.IsValid() && LevelGeneratorActor->GetMapPreset() != nullptr;
+    return LevelGeneratorActor.IsValid() && LevelGeneratorActor->GetMapPreset() != nullptr && !IsGeneratingMaps();
+}
+
+bool SOCGWidget::IsGeneratingMaps() const
+{
+    return LevelGeneratorActor.IsValid() && LevelGeneratorActor->IsGeneratingMaps();
+}
+
+EVisibility SOCGWidget::GetMapGenerationVisibility() const
+{
+    return IsGeneratingMaps() ? EVisibility::Visible : EVisibility::Collapsed;
+}
+
+TOptional<float> SOCGWidget::GetMapGenerationProgress() const
+{
+    if (!LevelGeneratorActor.IsValid())
+        return TOptional<float>();
+    return LevelGeneratorActor->GetMapGenerationProgress();
+}
+
+FText SOCGWidget::GetMapGenerationStageText() const
+{
+    if (!LevelGeneratorActor.IsValid())
+        return FText::GetEmpty();
+    return LevelGeneratorActor->GetMapGenerationStageText();
+}
+
+FReply SOCGWidget::OnCancelMapGenerationClicked()
+{
+    if (LevelGeneratorActor.IsValid())
+    {
+        LevelGeneratorActor->CancelMapGeneration();
+    }
+    return FReply::Handled();
 }
 
 void SOCGWidget::UpdateSelectedActor()
@@ -456,7 +523,7 @@ FReply SOCGWidget::OnRegenerateRiverClicked()
 
 bool SOCGWidget::IsRegenerateRiverButtonEnabled() const
 {
-    if (!LevelGeneratorActor.IsValid())
+    if (!LevelGeneratorActor.IsValid() || IsGeneratingMaps())
         return false;
     if (LevelGeneratorActor->GetLandscape())
         return true;
@@ -474,7 +541,7 @@ FReply SOCGWidget::OnForceGeneratePCGClicked()
 
 bool SOCGWidget::IsForceGeneratePCGButtonEnabled() const
 {
-    if (!LevelGeneratorActor.IsValid())
+    if (!LevelGeneratorActor.IsValid() || IsGeneratingMaps())
         return false;
     if (LevelGeneratorActor->GetLandscape())
         return true;
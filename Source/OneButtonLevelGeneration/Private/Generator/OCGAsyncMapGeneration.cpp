@@ -0,0 +1,104 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Generator/OCGAsyncMapGeneration.h"
+
+#include "OCGLog.h"
+#include "Async/Async.h"
+
+TSharedRef<FOCGAsyncMapGeneration> FOCGAsyncMapGeneration::Launch(UMapPreset* MapPreset, TArray<uint16>&& InHeightMap,
+	const TSharedPtr<FOCGMapStageCache, ESPMode::ThreadSafe>& StageCache, FOnCompleted&& OnCompleted)
+{
+	check(IsInGameThread());
+
+	TSharedRef<FOCGAsyncMapGeneration> Generation = MakeShareable(new FOCGAsyncMapGeneration(MapPreset, MoveTemp(InHeightMap), StageCache,
+		MoveTemp(OnCompleted)));
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Generation]()
+	{
+		Generation->Run();
+	});
+	return Generation;
+}
+
+FOCGAsyncMapGeneration::FOCGAsyncMapGeneration(UMapPreset* MapPreset, TArray<uint16>&& InHeightMap,
+	const TSharedPtr<FOCGMapStageCache, ESPMode::ThreadSafe>& StageCache, FOnCompleted&& InOnCompleted)
+	: Generator(MakeUnique<FOCGMapGenerator>(MapPreset, StageCache))
+	, InputHeightMap(MoveTemp(InHeightMap))
+	, OnCompleted(MoveTemp(InOnCompleted))
+{
+	NumStages = Generator->GetNumStages(!InputHeightMap.IsEmpty());
+	StageText = NSLOCTEXT("ONEBUTTONLEVELGENERATION_API", "MapGenerationQueued", "Starting map generation");
+}
+
+void FOCGAsyncMapGeneration::Cancel()
+{
+	bCancelRequested = true;
+}
+
+float FOCGAsyncMapGeneration::GetProgress() const
+{
+	return static_cast<float>(CompletedStages.load()) / FMath::Max(NumStages, 1);
+}
+
+FText FOCGAsyncMapGeneration::GetStageText() const
+{
+	FScopeLock Lock(&StageTextLock);
+	return StageText;
+}
+
+void FOCGAsyncMapGeneration::Run()
+{
+	const FOCGMapGenerationProgress Progress = [this](const FText& StageName, const int32 StageIndex, const int32 InNumStages)
+	{
+		return OnProgress(StageName, StageIndex, InNumStages);
+	};
+
+	bool bCompleted;
+	if (InputHeightMap.IsEmpty())
+	{
+		bCompleted = Generator->Generate(Result, Progress);
+	}
+	else
+	{
+		bCompleted = Generator->GenerateWithHeightMap(InputHeightMap, Result, Progress);
+	}
+	CompletedStages = NumStages;
+
+	// The generator holds the preset snapshot, release it on the game thread in Complete
+	AsyncTask(ENamedThreads::GameThread, [Generation = AsShared(), bCompleted]()
+	{
+		Generation->Complete(bCompleted);
+	});
+}
+
+bool FOCGAsyncMapGeneration::OnProgress(const FText& StageName, const int32 StageIndex, const int32 InNumStages)
+{
+	if (bCancelRequested)
+		return false;
+
+	CompletedStages = StageIndex;
+	FScopeLock Lock(&StageTextLock);
+	StageText = StageName;
+	return true;
+}
+
+void FOCGAsyncMapGeneration::Complete(const bool bCompleted)
+{
+	check(IsInGameThread());
+
+	Generator.Reset();
+	InputHeightMap.Empty();
+	bRunning = false;
+	if (!bCompleted)
+	{
+		UE_LOG(LogOCGModule, Log, TEXT("Async map generation cancelled"));
+	}
+
+	// Reset before calling, the callback may hold the last reference of its owner
+	FOnCompleted Callback = MoveTemp(OnCompleted);
+	OnCompleted = nullptr;
+	if (Callback)
+	{
+		Callback(bCompleted, Result);
+	}
+	Result = FOCGMapGenerationResult();
+}
@@ -0,0 +1,281 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Generator/OCGGenerationStageGraph.h"
+
+#include "Data/MapPreset.h"
+#include "Hash/xxhash.h"
+
+#define OCG_PRESET_INPUT(PropertyName) GET_MEMBER_NAME_CHECKED(UMapPreset, PropertyName)
+
+namespace
+{
+	const FName HeightAndTemperatureInputs[] =
+	{
+		OCG_PRESET_INPUT(Seed),
+		OCG_PRESET_INPUT(MapResolution),
+		OCG_PRESET_INPUT(HeightmapFilePath),
+		OCG_PRESET_INPUT(LandscapeScale),
+		OCG_PRESET_INPUT(ApplyScaleToNoise),
+		OCG_PRESET_INPUT(MinHeight),
+		OCG_PRESET_INPUT(MaxHeight),
+		OCG_PRESET_INPUT(SeaLevel),
+		OCG_PRESET_INPUT(bContainWater),
+		OCG_PRESET_INPUT(ContinentNoiseScale),
+		OCG_PRESET_INPUT(TerrainNoiseScale),
+		OCG_PRESET_INPUT(StandardNoiseOffset),
+		OCG_PRESET_INPUT(RedistributionFactor),
+		OCG_PRESET_INPUT(Octaves),
+		OCG_PRESET_INPUT(Lacunarity),
+		OCG_PRESET_INPUT(Persistence),
+		OCG_PRESET_INPUT(bIsland),
+		OCG_PRESET_INPUT(IslandFalloffExponent),
+		OCG_PRESET_INPUT(IslandShapeNoiseScale),
+		OCG_PRESET_INPUT(IslandShapeNoiseStrength),
+		OCG_PRESET_INPUT(MinTemp),
+		OCG_PRESET_INPUT(MaxTemp),
+		OCG_PRESET_INPUT(TemperatureNoiseScale),
+		OCG_PRESET_INPUT(TempDropPer1000Units),
+		OCG_PRESET_INPUT(bFuseHeightAndTemperaturePass),
+	};
+
+	const FName HumidityInputs[] =
+	{
+		OCG_PRESET_INPUT(MoistureFalloffRate),
+		OCG_PRESET_INPUT(TemperatureInfluenceOnHumidity),
+	};
+
+	const FName MapsInputs[] =
+	{
+		OCG_PRESET_INPUT(Biomes),
+		OCG_PRESET_INPUT(BiomeBlendRadius),
+		OCG_PRESET_INPUT(WaterBlendRadius),
+		OCG_PRESET_INPUT(bSmoothByMediumHeight),
+		OCG_PRESET_INPUT(MedianSmoothRadius),
+		OCG_PRESET_INPUT(bModifyTerrainByBiome),
+		OCG_PRESET_INPUT(PlainSmoothFactor),
+		OCG_PRESET_INPUT(BiomeNoiseScale),
+		OCG_PRESET_INPUT(BiomeNoiseAmplitude),
+		OCG_PRESET_INPUT(BiomeHeightBlendRadius),
+		OCG_PRESET_INPUT(bSmoothHeight),
+		OCG_PRESET_INPUT(GaussianBlurRadius),
+		OCG_PRESET_INPUT(bSmoothBySlope),
+		OCG_PRESET_INPUT(SmoothingIteration),
+		OCG_PRESET_INPUT(MaxSlopeAngle),
+		OCG_PRESET_INPUT(SmoothingStrength),
+		OCG_PRESET_INPUT(bErosion),
+		OCG_PRESET_INPUT(ErosionMethod),
+		OCG_PRESET_INPUT(NumErosionIterations),
+		OCG_PRESET_INPUT(ErosionRadius),
+		OCG_PRESET_INPUT(bParallelErosion),
+		OCG_PRESET_INPUT(DropletInertia),
+		OCG_PRESET_INPUT(SedimentCapacityFactor),
+		OCG_PRESET_INPUT(MinSedimentCapacity),
+		OCG_PRESET_INPUT(ErodeSpeed),
+		OCG_PRESET_INPUT(DepositSpeed),
+		OCG_PRESET_INPUT(EvaporateSpeed),
+		OCG_PRESET_INPUT(Gravity),
+		OCG_PRESET_INPUT(MaxDropletLifetime),
+		OCG_PRESET_INPUT(InitialWaterVolume),
+		OCG_PRESET_INPUT(InitialSpeed),
+		OCG_PRESET_INPUT(PipeErosionIterations),
+		OCG_PRESET_INPUT(PipeTimeStep),
+		OCG_PRESET_INPUT(PipeRainAmount),
+		OCG_PRESET_INPUT(PipeSedimentCapacity),
+		OCG_PRESET_INPUT(PipeDissolveRate),
+		OCG_PRESET_INPUT(PipeDepositRate),
+		OCG_PRESET_INPUT(PipeEvaporationRate),
+	};
+
+	const FName LandscapeInputs[] =
+	{
+		OCG_PRESET_INPUT(LandscapeMaterial),
+		OCG_PRESET_INPUT(Landscape_QuadsPerSection),
+		OCG_PRESET_INPUT(Landscape_SectionsPerComponent),
+		OCG_PRESET_INPUT(Landscape_ComponentCount),
+		OCG_PRESET_INPUT(WorldPartitionGridSize),
+		OCG_PRESET_INPUT(WorldPartitionRegionSize),
+	};
+
+	const FName TerrainInputs[] =
+	{
+		OCG_PRESET_INPUT(PCGGraph),
+		OCG_PRESET_INPUT(bAutoGenerate),
+		OCG_PRESET_INPUT(HierarchiesData),
+	};
+
+	const FName WaterInputs[] =
+	{
+		OCG_PRESET_INPUT(bContainWater),
+		OCG_PRESET_INPUT(MinHeight),
+		OCG_PRESET_INPUT(MaxHeight),
+		OCG_PRESET_INPUT(SeaLevel),
+		OCG_PRESET_INPUT(OceanWaterMaterial),
+		OCG_PRESET_INPUT(OceanWaterStaticMeshMaterial),
+		OCG_PRESET_INPUT(WaterHLODMaterial),
+		OCG_PRESET_INPUT(UnderwaterPostProcessMaterial),
+	};
+
+	// Curves are hashed by asset path, editing the keys of a curve asset does not change the river key
+	const FName RiverInputs[] =
+	{
+		OCG_PRESET_INPUT(bGenerateRiver),
+		OCG_PRESET_INPUT(RiverSeed),
+		OCG_PRESET_INPUT(RiverCount),
+		OCG_PRESET_INPUT(RiverPlacement),
+		OCG_PRESET_INPUT(RiverSourceElevationRatio),
+		OCG_PRESET_INPUT(RiverSplineSimplifyEpsilon),
+		OCG_PRESET_INPUT(RiverSplineSimplification),
+		OCG_PRESET_INPUT(RiverWidthBaseValue),
+		OCG_PRESET_INPUT(RiverDepthBaseValue),
+		OCG_PRESET_INPUT(RiverVelocityBaseValue),
+		OCG_PRESET_INPUT(RiverWidthMin),
+		OCG_PRESET_INPUT(RiverDepthMin),
+		OCG_PRESET_INPUT(RiverVelocityMin),
+		OCG_PRESET_INPUT(RiverWidthCurve),
+		OCG_PRESET_INPUT(RiverDepthCurve),
+		OCG_PRESET_INPUT(RiverVelocityCurve),
+		OCG_PRESET_INPUT(RiverWaterMaterial),
+		OCG_PRESET_INPUT(RiverWaterStaticMeshMaterial),
+		OCG_PRESET_INPUT(RiverToLakeTransitionMaterial),
+		OCG_PRESET_INPUT(RiverToOceanTransitionMaterial),
+	};
+
+	const EOCGGenerationStage HumidityUpstream[] = { EOCGGenerationStage::HeightAndTemperature };
+	const EOCGGenerationStage MapsUpstream[] = { EOCGGenerationStage::Humidity };
+	const EOCGGenerationStage LandscapeUpstream[] = { EOCGGenerationStage::Maps };
+	const EOCGGenerationStage TerrainUpstream[] = { EOCGGenerationStage::Landscape };
+	const EOCGGenerationStage WaterUpstream[] = { EOCGGenerationStage::Landscape };
+	const EOCGGenerationStage RiverUpstream[] = { EOCGGenerationStage::Landscape, EOCGGenerationStage::Water };
+
+	// Only the fields that change the generated maps, the display colour of a biome does not rerun anything
+	void HashBiomes(const TArray<FOCGBiomeSettings>& Biomes, FXxHash64Builder& Builder)
+	{
+		const int32 NumBiomes = Biomes.Num();
+		Builder.Update(&NumBiomes, sizeof(NumBiomes));
+		for (const FOCGBiomeSettings& Biome : Biomes)
+		{
+			const FString BiomeName = Biome.BiomeName.ToString();
+			Builder.Update(*BiomeName, BiomeName.Len() * sizeof(TCHAR));
+			Builder.Update(&Biome.Temperature, sizeof(Biome.Temperature));
+			Builder.Update(&Biome.Humidity, sizeof(Biome.Humidity));
+			Builder.Update(&Biome.Weight, sizeof(Biome.Weight));
+			Builder.Update(&Biome.MountainRatio, sizeof(Biome.MountainRatio));
+		}
+	}
+
+	uint64 HashPresetProperties(const UMapPreset* MapPreset, TConstArrayView<FName> PropertyNames)
+	{
+		FXxHash64Builder Builder;
+		FString ValueText;
+		for (const FName PropertyName : PropertyNames)
+		{
+			if (PropertyName == GET_MEMBER_NAME_CHECKED(UMapPreset, Biomes))
+			{
+				HashBiomes(MapPreset->Biomes, Builder);
+				continue;
+			}
+
+			const FProperty* Property = UMapPreset::StaticClass()->FindPropertyByName(PropertyName);
+			check(Property);
+
+			ValueText.Reset();
+			Property->ExportTextItem_InContainer(ValueText, MapPreset, nullptr, nullptr, PPF_None);
+			Builder.Update(*ValueText, ValueText.Len() * sizeof(TCHAR));
+		}
+		return Builder.Finalize().Hash;
+	}
+}
+
+#undef OCG_PRESET_INPUT
+
+const TCHAR* OCGStageGraph::GetStageName(const EOCGGenerationStage Stage)
+{
+	switch (Stage)
+	{
+	case EOCGGenerationStage::HeightAndTemperature: return TEXT("Height and Temperature");
+	case EOCGGenerationStage::Humidity: return TEXT("Humidity");
+	case EOCGGenerationStage::Maps: return TEXT("Maps");
+	case EOCGGenerationStage::Landscape: return TEXT("Landscape");
+	case EOCGGenerationStage::Terrain: return TEXT("Terrain");
+	case EOCGGenerationStage::Water: return TEXT("Water");
+	case EOCGGenerationStage::River: return TEXT("River");
+	default: return TEXT("Unknown");
+	}
+}
+
+TConstArrayView<FName> OCGStageGraph::GetPresetInputs(const EOCGGenerationStage Stage)
+{
+	switch (Stage)
+	{
+	case EOCGGenerationStage::HeightAndTemperature: return HeightAndTemperatureInputs;
+	case EOCGGenerationStage::Humidity: return HumidityInputs;
+	case EOCGGenerationStage::Maps: return MapsInputs;
+	case EOCGGenerationStage::Landscape: return LandscapeInputs;
+	case EOCGGenerationStage::Terrain: return TerrainInputs;
+	case EOCGGenerationStage::Water: return WaterInputs;
+	case EOCGGenerationStage::River: return RiverInputs;
+	default: return {};
+	}
+}
+
+TConstArrayView<EOCGGenerationStage> OCGStageGraph::GetUpstreamStages(const EOCGGenerationStage Stage)
+{
+	switch (Stage)
+	{
+	case EOCGGenerationStage::Humidity: return HumidityUpstream;
+	case EOCGGenerationStage::Maps: return MapsUpstream;
+	case EOCGGenerationStage::Landscape: return LandscapeUpstream;
+	case EOCGGenerationStage::Terrain: return TerrainUpstream;
+	case EOCGGenerationStage::Water: return WaterUpstream;
+	case EOCGGenerationStage::River: return RiverUpstream;
+	default: return {};
+	}
+}
+
+FOCGStageKeys OCGStageGraph::HashPresetInputs(const UMapPreset* MapPreset)
+{
+	check(IsInGameThread());
+	check(MapPreset);
+
+	FOCGStageKeys Hashes;
+	for (int32 StageIndex = 0; StageIndex < static_cast<int32>(EOCGGenerationStage::Num); ++StageIndex)
+	{
+		const EOCGGenerationStage Stage = static_cast<EOCGGenerationStage>(StageIndex);
+		Hashes.Set(Stage, HashPresetProperties(MapPreset, GetPresetInputs(Stage)));
+	}
+	return Hashes;
+}
+
+FOCGStageKeys OCGStageGraph::ChainStageKeys(const FOCGStageKeys& PresetInputHashes, const uint64 ExternalInputKey)
+{
+	// Upstream stages always come first in EOCGGenerationStage, so one pass in order sees every upstream key
+	FOCGStageKeys Keys;
+	for (int32 StageIndex = 0; StageIndex < static_cast<int32>(EOCGGenerationStage::Num); ++StageIndex)
+	{
+		const EOCGGenerationStage Stage = static_cast<EOCGGenerationStage>(StageIndex);
+
+		FXxHash64Builder Builder;
+		const uint64 InputHash = PresetInputHashes.Get(Stage);
+		Builder.Update(&StageIndex, sizeof(StageIndex));
+		Builder.Update(&InputHash, sizeof(InputHash));
+		if (StageIndex == 0)
+		{
+			Builder.Update(&ExternalInputKey, sizeof(ExternalInputKey));
+		}
+		for (const EOCGGenerationStage UpstreamStage : GetUpstreamStages(Stage))
+		{
+			check(UpstreamStage < Stage);
+			const uint64 UpstreamKey = Keys.Get(UpstreamStage);
+			Builder.Update(&UpstreamKey, sizeof(UpstreamKey));
+		}
+
+		// Keep 0 free for stages that never ran
+		Keys.Set(Stage, FMath::Max<uint64>(Builder.Finalize().Hash, 1));
+	}
+	return Keys;
+}
+
+uint64 OCGStageGraph::HashHeightMap(const TArray<uint16>& InHeightMap)
+{
+	return FXxHash64::HashBuffer(InHeightMap.GetData(), InHeightMap.Num() * sizeof(uint16)).Hash;
+}
@@ -0,0 +1,1791 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Generator/OCGMapGenerator.h"
+
+#include "OCGDeveloperSettings.h"
+#include "OCGLog.h"
+#include "Data/MapData.h"
+#include "Data/MapPreset.h"
+#include "Data/OCGBiomeSettings.h"
+#include "Generator/OCGMapLayerCache.h"
+#include "Utils/OCGBlur.h"
+#include "Utils/OCGDistanceTransform.h"
+#include "Utils/OCGHydraulicErosion.h"
+#include "Utils/OCGMedianFilter.h"
+#include "Utils/OCGNoise.h"
+#include "Utils/OCGParallelUtils.h"
+
+namespace
+{
+    // Temperature and humidity are quantized to their top 8 bits in the biome lookup table
+    constexpr int32 BiomeLookupBucketShift = 8;
+    constexpr int32 BiomeLookupTableSize = 65536 >> BiomeLookupBucketShift;
+}
+
+FOCGMapGenerator::FOCGMapGenerator(UMapPreset* InMapPreset, const TSharedPtr<FOCGMapStageCache, ESPMode::ThreadSafe>& InStageCache)
+    : Settings(CreateSettingsSnapshot(InMapPreset))
+    , PresetInputHashes(OCGStageGraph::HashPresetInputs(Settings.Get()))
+    , StageCache(InStageCache)
+{
+    const UOCGDeveloperSettings* DeveloperSettings = GetDefault<UOCGDeveloperSettings>();
+    if (DeveloperSettings && DeveloperSettings->bMapLayerCache)
+    {
+        bUseLayerCache = true;
+        LayerCacheVersionHash = OCGMapLayerCache::GetVersionHash();
+        LayerCacheMaxBytes = static_cast<int64>(DeveloperSettings->MapLayerCacheSizeMB) * 1024 * 1024;
+    }
+}
+
+TStrongObjectPtr<UMapPreset> FOCGMapGenerator::CreateSettingsSnapshot(UMapPreset* InMapPreset)
+{
+    check(IsInGameThread());
+    check(InMapPreset);
+
+    // The generated maps are outputs, keep them out of the copy instead of duplicating hundreds of MB
+    TArray<uint16> HeightMapData = MoveTemp(InMapPreset->HeightMapData);
+    TArray<uint16> TemperatureMapData = MoveTemp(InMapPreset->TemperatureMapData);
+    TArray<uint16> HumidityMapData = MoveTemp(InMapPreset->HumidityMapData);
+
+    TStrongObjectPtr<UMapPreset> Snapshot(DuplicateObject<UMapPreset>(InMapPreset, GetTransientPackage()));
+
+    InMapPreset->HeightMapData = MoveTemp(HeightMapData);
+    InMapPreset->TemperatureMapData = MoveTemp(TemperatureMapData);
+    InMapPreset->HumidityMapData = MoveTemp(HumidityMapData);
+    return Snapshot;
+}
+
+int32 FOCGMapGenerator::GetNumStages(const bool bWithHeightMap) const
+{
+    // The map layer cache lookup is a stage of its own
+    const int32 NumCacheStages = bUseLayerCache ? 1 : 0;
+    if (bWithHeightMap)
+        return 5 + NumCacheStages;
+    return (Settings->bFuseHeightAndTemperaturePass ? 9 : 10) + NumCacheStages;
+}
+
+bool FOCGMapGenerator::RunStage(const TCHAR* StageName, const FOCGMapGenerationProgress& OnProgress, TFunctionRef<void()> Stage)
+{
+    if (OnProgress && !OnProgress(FText::FromString(StageName), CurrentStageIndex, CurrentNumStages))
+    {
+        UE_LOG(LogOCGModule, Log, TEXT("Map generation cancelled before %s"), StageName);
+        return false;
+    }
+    ++CurrentStageIndex;
+
+    TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(StageName);
+    StageStats.BeginStage(&ScratchBuffers);
+    Stage();
+    StageStats.EndStage(StageName, CurrentNumPixels, &ScratchBuffers);
+    return true;
+}
+
+bool FOCGMapGenerator::Generate(FOCGMapGenerationResult& OutResult, const FOCGMapGenerationProgress& OnProgress)
+{
+    LLM_SCOPE_BYTAG(OCGMapGeneration);
+    TRACE_CPUPROFILER_EVENT_SCOPE(FOCGMapGenerator::Generate);
+    const double GenerationStartTime = FPlatformTime::Seconds();
+
+    const UMapPreset* MapPreset = Settings.Get();
+    Initialize(MapPreset);
+    CurrentNumStages = GetNumStages(false);
+    StageKeys = OCGStageGraph::ChainStageKeys(PresetInputHashes);
+
+    const FIntPoint CurMapResolution = MapPreset->MapResolution;
+    CurrentNumPixels = static_cast<int64>(CurMapResolution.X) * CurMapResolution.Y;
+
+    const uint64 LayerCacheKey = GetLayerCacheKey();
+    bool bLoadedFromCache = false;
+    if (LayerCacheKey != 0 && !RunStage(TEXT("Loading Cached Maps"), OnProgress, [&]()
+    {
+        bLoadedFromCache = LoadFromLayerCache(LayerCacheKey, OutResult);
+    }))
+        return false;
+    if (bLoadedFromCache)
+    {
+        OutResult.Stages = StageStats.GetStages();
+        return true;
+    }
+
+    TArray<uint16> HeightMapData;
+    TArray<uint16> TemperatureMapData;
+    TArray<uint16> HumidityMapData;
+    TArray<const FOCGBiomeSettings*> BiomeMap;
+
+    if (MapPreset->bFuseHeightAndTemperaturePass)
+    {
+        // Fill Height and Temperature Map in one pass
+        if (!RunStage(TEXT("Generating Height and Temperature Map"), OnProgress, [&]()
+        {
+            if (!RestoreHeightAndTemperature(MapPreset, HeightMapData, TemperatureMapData))
+            {
+                GenerateHeightAndTempMap(MapPreset, CurMapResolution, HeightMapData, TemperatureMapData);
+                StoreHeightAndTemperature(HeightMapData, TemperatureMapData);
+            }
+        }))
+            return false;
+    }
+    else
+    {
+        bool bRestored = false;
+        // Fill Height Map
+        if (!RunStage(TEXT("Generating Height Map"), OnProgress, [&]()
+        {
+            bRestored = RestoreHeightAndTemperature(MapPreset, HeightMapData, TemperatureMapData);
+            if (!bRestored)
+            {
+                GenerateHeightMap(MapPreset, CurMapResolution, HeightMapData);
+            }
+        }))
+            return false;
+        // Fill Temperature Map
+        if (!RunStage(TEXT("Generating Temperature Map"), OnProgress, [&]()
+        {
+            if (!bRestored)
+            {
+                GenerateTempMap(MapPreset, HeightMapData, TemperatureMapData);
+                StoreHeightAndTemperature(HeightMapData, TemperatureMapData);
+            }
+        }))
+            return false;
+    }
+    // Fill Humidity Map
+    if (!RunStage(TEXT("Generating Humidity Map"), OnProgress, [&]()
+    {
+        if (!RestoreHumidity(MapPreset, HumidityMapData))
+        {
+            GenerateHumidityMap(MapPreset, HeightMapData, TemperatureMapData, HumidityMapData);
+            StoreHumidity(HumidityMapData);
+        }
+    }))
+        return false;
+    // Decide Biome based on Height, Temperature, Humidity Map
+    if (!RunStage(TEXT("Generating Biome Map"), OnProgress, [&]()
+    {
+        DecideBiome(MapPreset, HeightMapData, TemperatureMapData, HumidityMapData, BiomeMap, false, MapPreset->bModifyTerrainByBiome);
+    }))
+        return false;
+    // Modify Height Map based on biome if needed
+    if (!RunStage(TEXT("Modifying Heightmap with Biome"), OnProgress, [&]()
+    {
+        ModifyLandscapeWithBiome(MapPreset, HeightMapData);
+    }))
+        return false;
+    // Smooth Height Map if needed
+    if (!RunStage(TEXT("Smoothing Height Map"), OnProgress, [&]()
+    {
+        SmoothHeightMap(MapPreset, HeightMapData);
+    }))
+        return false;
+    // Recalculate biome based on modified height map
+    if (!RunStage(TEXT("Finalizing Biome Map"), OnProgress, [&]()
+    {
+        FinalizeBiome(MapPreset, HeightMapData, TemperatureMapData, HumidityMapData, BiomeMap);
+    }))
+        return false;
+    // Erosion pass
+    if (!RunStage(TEXT("Working on Erosion"), OnProgress, [&]()
+    {
+        ErosionPass(MapPreset, HeightMapData);
+    }))
+        return false;
+    // Calculate max & min height from current Height Map
+    if (!RunStage(TEXT("Calculating max and min heights"), OnProgress, [&]()
+    {
+        GetMaxMinHeight(MapPreset, HeightMapData);
+    }))
+        return false;
+    // Export Height Map as png
+    if (!RunStage(TEXT("Exporting Height Map as PNG"), OnProgress, [&]()
+    {
+        ExportMap(MapPreset, HeightMapData, "HeightMap.png");
+    }))
+        return false;
+
+    UE_LOG(LogOCGModule, Log, TEXT("Map generation (%dx%d) took %.2f ms"), CurMapResolution.X, CurMapResolution.Y,
+        (FPlatformTime::Seconds() - GenerationStartTime) * 1000.0);
+
+    OutResult.HeightMap = MoveTemp(HeightMapData);
+    OutResult.TemperatureMap = MoveTemp(TemperatureMapData);
+    OutResult.HumidityMap = MoveTemp(HumidityMapData);
+    MoveResultTo(OutResult);
+    StoreInLayerCache(LayerCacheKey, OutResult);
+    return true;
+}
+
+bool FOCGMapGenerator::GenerateWithHeightMap(const TArray<uint16>& InHeightMap, FOCGMapGenerationResult& OutResult,
+    const FOCGMapGenerationProgress& OnProgress)
+{
+    LLM_SCOPE_BYTAG(OCGMapGeneration);
+    TRACE_CPUPROFILER_EVENT_SCOPE(FOCGMapGenerator::GenerateWithHeightMap);
+    const double GenerationStartTime = FPlatformTime::Seconds();
+
+    const UMapPreset* MapPreset = Settings.Get();
+    CurrentNumPixels = static_cast<int64>(MapPreset->MapResolution.X) * MapPreset->MapResolution.Y;
+    if (InHeightMap.Num() != CurrentNumPixels)
+    {
+        UE_LOG(LogOCGModule, Error, TEXT("Imported height map has %d pixels, the preset resolution needs %lld"), InHeightMap.Num(), CurrentNumPixels);
+        return false;
+    }
+
+    Initialize(MapPreset);
+    CurrentNumStages = GetNumStages(true);
+    StageKeys = OCGStageGraph::ChainStageKeys(PresetInputHashes, OCGStageGraph::HashHeightMap(InHeightMap));
+
+    const uint64 LayerCacheKey = GetLayerCacheKey();
+    bool bLoadedFromCache = false;
+    if (LayerCacheKey != 0 && !RunStage(TEXT("Loading Cached Maps"), OnProgress, [&]()
+    {
+        bLoadedFromCache = LoadFromLayerCache(LayerCacheKey, OutResult);
+    }))
+        return false;
+    if (bLoadedFromCache)
+    {
+        OutResult.Stages = StageStats.GetStages();
+        return true;
+    }
+
+    // Own copy, the caller may keep using its height map while the stages run
+    TArray<uint16> HeightMapData = InHeightMap;
+    TArray<uint16> TemperatureMapData;
+    TArray<uint16> HumidityMapData;
+    TArray<const FOCGBiomeSettings*> BiomeMap;
+
+    // Generate Temperature Map
+    if (!RunStage(TEXT("Generating Temperature Map"), OnProgress, [&]()
+    {
+        if (!RestoreHeightAndTemperature(MapPreset, HeightMapData, TemperatureMapData))
+        {
+            GenerateTempMap(MapPreset, HeightMapData, TemperatureMapData);
+            StoreHeightAndTemperature(HeightMapData, TemperatureMapData);
+        }
+    }))
+        return false;
+    // Generate Humidity Map
+    if (!RunStage(TEXT("Generating Humidity Map"), OnProgress, [&]()
+    {
+        if (!RestoreHumidity(MapPreset, HumidityMapData))
+        {
+            GenerateHumidityMap(MapPreset, HeightMapData, TemperatureMapData, HumidityMapData);
+            StoreHumidity(HumidityMapData);
+        }
+    }))
+        return false;
+    // Decide Biome based on Height, Temperature, Humidity Map
+    if (!RunStage(TEXT("Generating Biome Map"), OnProgress, [&]()
+    {
+        DecideBiome(MapPreset, HeightMapData, TemperatureMapData, HumidityMapData, BiomeMap, true);
+    }))
+        return false;
+    // Calculate max & min height from current Height Map
+    if (!RunStage(TEXT("Calculating max and min heights"), OnProgress, [&]()
+    {
+        GetMaxMinHeight(MapPreset, HeightMapData);
+    }))
+        return false;
+    // Export Height Map as png
+    if (!RunStage(TEXT("Exporting Height Map as PNG"), OnProgress, [&]()
+    {
+        ExportMap(MapPreset, HeightMapData, "HeightMap.png");
+    }))
+        return false;
+
+    UE_LOG(LogOCGModule, Log, TEXT("Map generation with imported height map took %.2f ms"),
+        (FPlatformTime::Seconds() - GenerationStartTime) * 1000.0);
+
+    OutResult.HeightMap = MoveTemp(HeightMapData);
+    OutResult.TemperatureMap = MoveTemp(TemperatureMapData);
+    OutResult.HumidityMap = MoveTemp(HumidityMapData);
+    MoveResultTo(OutResult);
+    StoreInLayerCache(LayerCacheKey, OutResult);
+    return true;
+}
+
+void FOCGMapGenerator::MoveResultTo(FOCGMapGenerationResult& OutResult)
+{
+    OutResult.Resolution = Settings->MapResolution;
+    OutResult.WeightLayers = MoveTemp(WeightLayers);
+    OutResult.BiomeColorMap = MoveTemp(BiomeColorMap);
+    OutResult.BiomeIndexMap = MoveTemp(BiomeIndexMap);
+    OutResult.BiomeRegions = MoveTemp(BiomeRegions);
+    OutResult.CurMinHeight = CurMinHeight;
+    OutResult.CurMaxHeight = CurMaxHeight;
+    OutResult.LandscapeZScale = LandscapeZScale;
+    OutResult.ZOffset = ZOffset;
+    OutResult.Stages = StageStats.GetStages();
+
+    // Scratch buffers are only shared between the stages of one run
+    MountainRatioMap.Empty();
+    ScratchBuffers.Empty();
+}
+
+uint64 FOCGMapGenerator::GetLayerCacheKey() const
+{
+    if (!bUseLayerCache)
+        return 0;
+    return OCGMapLayerCache::MakeKey(StageKeys.Get(EOCGGenerationStage::Maps), LayerCacheVersionHash);
+}
+
+bool FOCGMapGenerator::LoadFromLayerCache(const uint64 LayerCacheKey, FOCGMapGenerationResult& OutResult) const
+{
+    const UMapPreset* MapPreset = Settings.Get();
+    if (!OCGMapLayerCache::Load(LayerCacheKey, MapPreset->MapResolution, MapPreset->Biomes.Num() + 1, OutResult))
+        return false;
+
+    // The layer count follows the biome list, which is part of the key, so a mismatch means a broken entry
+    if (OutResult.WeightLayers.Num() != MapPreset->Biomes.Num() + 1)
+    {
+        OutResult = FOCGMapGenerationResult();
+        return false;
+    }
+
+    UE_LOG(LogOCGModule, Log, TEXT("Loaded %dx%d maps from the map layer cache"), MapPreset->MapResolution.X, MapPreset->MapResolution.Y);
+    // Every exported map is written again, so no PNG of an earlier run or preset is left behind
+    ExportMap(MapPreset, OutResult.TemperatureMap, "TempMap.png");
+    ExportMap(MapPreset, OutResult.HumidityMap, "HumidityMap.png");
+    ExportMap(MapPreset, OutResult.BiomeColorMap, "BiomeMap1.png");
+    ExportMap(MapPreset, OutResult.HeightMap, "HeightMap.png");
+    ExportWeightLayers(MapPreset, OutResult.WeightLayers);
+    return true;
+}
+
+void FOCGMapGenerator::StoreInLayerCache(const uint64 LayerCacheKey, const FOCGMapGenerationResult& Result) const
+{
+    if (LayerCacheKey == 0)
+        return;
+
+    OCGMapLayerCache::Save(LayerCacheKey, Result);
+    if (LayerCacheMaxBytes > 0)
+    {
+        OCGMapLayerCache::Trim(LayerCacheMaxBytes);
+    }
+}
+
+bool FOCGMapGenerator::RestoreHeightAndTemperature(const UMapPreset* MapPreset, TArray<uint16>& OutHeightMap, TArray<uint16>& OutTempMap)
+{
+    const uint64 Key = StageKeys.Get(EOCGGenerationStage::HeightAndTemperature);
+    if (!StageCache.IsValid() || StageCache->HeightAndTemperatureKey != Key)
+        return false;
+
+    OutHeightMap = StageCache->HeightMap;
+    OutTempMap = StageCache->TemperatureMap;
+    CachedGlobalMinTemp = StageCache->MinTemp;
+    CachedGlobalMaxTemp = StageCache->MaxTemp;
+    UE_LOG(LogOCGModule, Log, TEXT("Height and temperature maps are up to date, reused from the last run"));
+
+    ExportMap(MapPreset, OutTempMap, "TempMap.png");
+    return true;
+}
+
+void FOCGMapGenerator::StoreHeightAndTemperature(const TArray<uint16>& InHeightMap, const TArray<uint16>& InTempMap)
+{
+    if (!StageCache.IsValid())
+        return;
+
+    LLM_SCOPE_BYTAG(OCGMapGeneration);
+    StageCache->HeightAndTemperatureKey = StageKeys.Get(EOCGGenerationStage::HeightAndTemperature);
+    StageCache->HeightMap = InHeightMap;
+    StageCache->TemperatureMap = InTempMap;
+    StageCache->MinTemp = CachedGlobalMinTemp;
+    StageCache->MaxTemp = CachedGlobalMaxTemp;
+    // Humidity is computed from these maps, its cached copy is stale now
+    StageCache->HumidityKey = 0;
+}
+
+bool FOCGMapGenerator::RestoreHumidity(const UMapPreset* MapPreset, TArray<uint16>& OutHumidityMap)
+{
+    const uint64 Key = StageKeys.Get(EOCGGenerationStage::Humidity);
+    if (!StageCache.IsValid() || StageCache->HumidityKey != Key)
+        return false;
+
+    OutHumidityMap = StageCache->HumidityMap;
+    CachedGlobalMinHumidity = StageCache->MinHumidity;
+    CachedGlobalMaxHumidity = StageCache->MaxHumidity;
+    UE_LOG(LogOCGModule, Log, TEXT("Humidity map is up to date, reused from the last run"));
+
+    ExportMap(MapPreset, OutHumidityMap, "HumidityMap.png");
+    return true;
+}
+
+void FOCGMapGenerator::StoreHumidity(const TArray<uint16>& InHumidityMap)
+{
+    if (!StageCache.IsValid())
+        return;
+
+    LLM_SCOPE_BYTAG(OCGMapGeneration);
+    StageCache->HumidityKey = StageKeys.Get(EOCGGenerationStage::Humidity);
+    StageCache->HumidityMap = InHumidityMap;
+    StageCache->MinHumidity = CachedGlobalMinHumidity;
+    StageCache->MaxHumidity = CachedGlobalMaxHumidity;
+}
+
+void FOCGMapGenerator::BenchmarkErosion(const TArray<uint16>& InHeightMap)
+{
+    const UMapPreset* MapPreset = Settings.Get();
+    if (InHeightMap.Num() != MapPreset->MapResolution.X * MapPreset->MapResolution.Y || MapPreset->NumErosionIterations <= 0)
+    {
+        UE_LOG(LogOCGModule, Warning, TEXT("BenchmarkErosion: Generate maps first, the current height map is used as erosion input"));
+        return;
+    }
+
+    // Height conversion needs the Z scale of the preset
+    Initialize(MapPreset);
+
+    // Eroded volume in height map units, tells how much work each pass did
+    auto GetErodedAmount = [&InHeightMap](const TArray<uint16>& InErodedHeightMap)
+    {
+        double Sum = 0.0;
+        for (int32 i = 0; i < InErodedHeightMap.Num(); ++i)
+        {
+            Sum += FMath::Abs(static_cast<int32>(InHeightMap[i]) - static_cast<int32>(InErodedHeightMap[i]));
+        }
+        return Sum;
+    };
+
+    TArray<uint16> SerialHeightMap = InHeightMap;
+    FRandomStream SerialStream(MapPreset->Seed);
+    const double SerialStartTime = FPlatformTime::Seconds();
+    ApplyDropletErosion(MapPreset, SerialHeightMap, false, SerialStream);
+    const double SerialTime = FPlatformTime::Seconds() - SerialStartTime;
+
+    TArray<uint16> ParallelHeightMap = InHeightMap;
+    const double ParallelStartTime = FPlatformTime::Seconds();
+    ApplyDropletErosion(MapPreset, ParallelHeightMap, true, SerialStream);
+    const double ParallelTime = FPlatformTime::Seconds() - ParallelStartTime;
+
+    // Difference between the two results
+    double SumDifference = 0.0;
+    int32 MaxDifference = 0;
+    for (int32 i = 0; i < SerialHeightMap.Num(); ++i)
+    {
+        const int32 Difference = FMath::Abs(static_cast<int32>(SerialHeightMap[i]) - static_cast<int32>(ParallelHeightMap[i]));
+        SumDifference += Difference;
+        MaxDifference = FMath::Max(MaxDifference, Difference);
+    }
+
+    UE_LOG(LogOCGModule, Log, TEXT("Erosion benchmark (%dx%d, %d droplets)"), MapPreset->MapResolution.X, MapPreset->MapResolution.Y, MapPreset->NumErosionIterations);
+    UE_LOG(LogOCGModule, Log, TEXT("  Serial   : %.2f ms, eroded volume %.0f"), SerialTime * 1000.0, GetErodedAmount(SerialHeightMap));
+    UE_LOG(LogOCGModule, Log, TEXT("  Parallel : %.2f ms, eroded volume %.0f (%.2fx speedup)"), ParallelTime * 1000.0, GetErodedAmount(ParallelHeightMap),
+        ParallelTime > 0.0 ? SerialTime / ParallelTime : 0.0);
+    UE_LOG(LogOCGModule, Log, TEXT("  Height difference : mean %.2f, max %d"), SumDifference / SerialHeightMap.Num(), MaxDifference);
+
+    ScratchBuffers.Empty();
+}
+
+float FOCGMapGenerator::HeightMapToWorldHeight(uint16 Height) const
+{
+    // Add ZOffset to return actual world Height, ZOffset is 0 if absolute value of max & min height is same
+    return (Height - 32768.f) * LandscapeZScale / 128.f + ZOffset;
+}
+
+uint16 FOCGMapGenerator::WorldHeightToHeightMap(float Height) const
+{
+    // Subtract ZOffset to return actual Height Map value, ZOffset is 0 if absolute value of max & min height is same
+    return static_cast<uint16>((Height - ZOffset) * 128.f / LandscapeZScale + 32768.f);
+}
+
+float FOCGMapGenerator::GetSeaLevelWorldHeight(const UMapPreset* MapPreset)
+{
+    if (!MapPreset->bContainWater)
+        return MapPreset->MinHeight;
+    return MapPreset->MinHeight + MapPreset->SeaLevel * (MapPreset->MaxHeight - MapPreset->MinHeight);
+}
+
+void FOCGMapGenerator::Initialize(const UMapPreset* MapPreset)
+{
+    Stream.Initialize(MapPreset->Seed);
+    
+    NoiseScale = 1;
+    if (MapPreset->ApplyScaleToNoise)
+    {
+        // Alter noise scale based on LandscapeScale, use log so that scale does not increase linearly
+        // Linearly increasing scale results in too high scale
+        float LandscapeScale = MapPreset->LandscapeScale; 
+        if (LandscapeScale > 0.f)
+            NoiseScale = FMath::LogX(25.f, LandscapeScale) + 1;
+    }
+    
+    InitializeNoiseOffsets(MapPreset);
+
+    // Set height of Plain to just above sea level
+    if (MapPreset->bContainWater)
+    {
+        PlainHeight = MapPreset->SeaLevel * 1.005f;
+    }
+    else
+    {
+        // bContainWater is false plain height is min height
+        PlainHeight = 0.f;
+    }
+
+    // Landscape scale formula, works only when absolute value of max & min height is same
+    // To solve this the landscape is moved in Z direction by ZOffset
+    LandscapeZScale = (MapPreset->MaxHeight - MapPreset->MinHeight) * 0.001953125f;
+
+    float AbsMaxHeight = FMath::Abs(MapPreset->MaxHeight);
+    float AbsMinHeight = FMath::Abs(MapPreset->MinHeight);
+    float AbsOffset = FMath::Abs(AbsMaxHeight - AbsMinHeight) / 2.0f;
+
+    ZOffset = (AbsMaxHeight < AbsMinHeight) ? -AbsOffset : AbsOffset;
+    
+    WeightLayers.Empty();
+    MountainRatioMap.Empty();
+    ScratchBuffers.Empty();
+    StageStats.ResetStages();
+    CurrentStageIndex = 0;
+}
+
+void FOCGMapGenerator::InitializeNoiseOffsets(const UMapPreset* MapPreset)
+{
+    float StandardNoiseOffset = MapPreset->StandardNoiseOffset * NoiseScale;
+    PlainNoiseOffset.X = Stream.FRandRange(-StandardNoiseOffset, StandardNoiseOffset);
+    PlainNoiseOffset.Y = Stream.FRandRange(-StandardNoiseOffset, StandardNoiseOffset);
+
+    MountainNoiseOffset.X = Stream.FRandRange(-StandardNoiseOffset, StandardNoiseOffset);
+    MountainNoiseOffset.Y = Stream.FRandRange(-StandardNoiseOffset, StandardNoiseOffset);
+    
+    BlendNoiseOffset.X = Stream.FRandRange(-StandardNoiseOffset, StandardNoiseOffset);
+    BlendNoiseOffset.Y = Stream.FRandRange(-StandardNoiseOffset, StandardNoiseOffset);
+
+    DetailNoiseOffset.X = Stream.FRandRange(-StandardNoiseOffset, StandardNoiseOffset);
+    DetailNoiseOffset.Y = Stream.FRandRange(-StandardNoiseOffset, StandardNoiseOffset);
+
+    IslandNoiseOffset.X = Stream.FRandRange(-StandardNoiseOffset, StandardNoiseOffset);
+    IslandNoiseOffset.Y = Stream.FRandRange(-StandardNoiseOffset, StandardNoiseOffset);
+}
+
+void FOCGMapGenerator::GenerateHeightMap(const UMapPreset* MapPreset, const FIntPoint CurMapResolution, TArray<uint16>& OutHeightMap)
+{
+    OutHeightMap.SetNumUninitialized(CurMapResolution.X * CurMapResolution.Y);
+    
+    // Fill Height Map
+    // Each pixel only depends on its own coordinate, so bands of rows are filled in parallel.
+    // The result is identical to a serial pass no matter how many threads are used
+    FOCGParallelUtils::ParallelForRows(CurMapResolution.Y, MapPreset->MaxGenerationThreads, [&](const int32 StartY, const int32 EndY)
+    {
+        TArray<float> RowHeights;
+        RowHeights.SetNumUninitialized(CurMapResolution.X);
+        TArray<float> RowScratch;
+        RowScratch.SetNumUninitialized(CurMapResolution.X * 2);
+
+        for (int32 y = StartY; y < EndY; ++y)
+        {
+            // returns values between 0~1
+            CalculateHeightRow(MapPreset, y, RowHeights.GetData(), RowScratch.GetData());
+            for (int32 x = 0; x < CurMapResolution.X; ++x)
+            {
+                // convert 0~1 value to 0~65535 which is the range of height map
+                const float NormalizedHeight = RowHeights[x] * 65535.f;
+                const uint16 HeightValue = FMath::Clamp(FMath::RoundToInt(NormalizedHeight), 0, 65535);
+                OutHeightMap[y * CurMapResolution.X + x] = HeightValue;
+            }
+        }
+    });
+}
+
+void FOCGMapGenerator::CalculateHeightRow(const UMapPreset* MapPreset, const int32 InY, float* OutHeights, float* Scratch) const
+{
+    // Noise of a whole row is sampled in batches first, then combined per pixel
+    const int32 Width = MapPreset->MapResolution.X;
+    float* TerrainNoise = Scratch;
+    float* BlendNoise = Scratch + Width;
+    const float ContinentNoiseScale = MapPreset->ContinentNoiseScale * NoiseScale;
+
+	// 1. Use Low frequency noise to generate large mountains
+    // -1~1 Range
+    OCGNoise::PerlinRow(FVector2f(MountainNoiseOffset), ContinentNoiseScale, 0, InY, Width, OutHeights);
+
+    // 2. Add details using high frequency to add details to Mountains generated in step 1
+    FOCGFractalNoiseSettings TerrainNoiseSettings;
+    TerrainNoiseSettings.Offset = FVector2f(DetailNoiseOffset);
+    TerrainNoiseSettings.Scale = MapPreset->TerrainNoiseScale * NoiseScale;
+    TerrainNoiseSettings.Octaves = MapPreset->Octaves;
+    TerrainNoiseSettings.Persistence = MapPreset->Persistence;
+    TerrainNoiseSettings.Lacunarity = MapPreset->Lacunarity;
+    // Normalized Terrain Noise (-1~1)
+    OCGNoise::FractalRow(TerrainNoiseSettings, 0, InY, Width, TerrainNoise);
+
+    // 3. Generate Blend mask that blends mountain and plain
+    OCGNoise::PerlinRow(FVector2f(BlendNoiseOffset), ContinentNoiseScale, 0, InY, Width, BlendNoise);
+
+    for (int32 x = 0; x < Width; ++x)
+    {
+        float MountainHeight = OutHeights[x] * 2.f;
+        MountainHeight = FMath::Clamp(MountainHeight, -1.f, 1.f);
+        MountainHeight += TerrainNoise[x] * 0.3f;
+        MountainHeight = FMath::Clamp(MountainHeight, -1.f, 1.f);
+
+        // 0~1 Range
+        float Blend = BlendNoise[x] * 0.5f + 0.5f;
+        // Redistribute BlendNoise so that Mountain region and Plain region is clear
+        if (MapPreset->RedistributionFactor > 1.f && Blend > 0.f && Blend < 1.f)
+        {
+            float PowX = FMath::Pow(Blend, MapPreset->RedistributionFactor);
+            float Pow1_X = FMath::Pow(1 - Blend, MapPreset->RedistributionFactor);
+            Blend = PowX / (PowX + Pow1_X);
+        }
+        Blend = FMath::SmoothStep(0.f, 1.f, Blend);
+
+        // 4. Apply Blend mask and blend heights
+        MountainHeight = MountainHeight * 0.5f + 0.5f; // Change range of Mountain height from -1~1 to 0~1
+        float Height = FMath::Lerp(PlainHeight, MountainHeight, Blend);
+        OutHeights[x] = FMath::Clamp(Height, 0.f, 1.f);
+    }
+
+    // 5. Apply Island shape
+    if (MapPreset->bIsland)
+    {
+        // Terrain noise is already applied, reuse its buffer
+        float* IslandNoise = TerrainNoise;
+        // Generate coastline noise so that island is not perfect circle, -1~1 range
+        OCGNoise::PerlinRow(FVector2f(IslandNoiseOffset), MapPreset->IslandShapeNoiseScale * NoiseScale, 0, InY, Width, IslandNoise);
+
+        const float ny = (static_cast<float>(InY) / MapPreset->MapResolution.Y) * 2.f - 1.f;
+        for (int32 x = 0; x < Width; ++x)
+        {
+            // Calculate current pixels distance from center of landscape;
+            float nx = (static_cast<float>(x) / MapPreset->MapResolution.X) * 2.f - 1.f;
+            float Distance = FMath::Sqrt(nx * nx + ny * ny);
+            // Apply IslandNoise to Distance so that coastline is random
+            float DistortedDistance = Distance + IslandNoise[x] * MapPreset->IslandShapeNoiseStrength;
+            // Generate final Island mask and apply to height map
+            float IslandMask = 1.f - DistortedDistance;
+            // multiply IslandMask by 3 so that the distribution shifts closer to 1 and more land will be shown
+            IslandMask *= 3.f;
+            IslandMask = FMath::Clamp(IslandMask, 0.f, 1.f);
+            IslandMask = FMath::Pow(IslandMask, MapPreset->IslandFalloffExponent);
+            IslandMask = FMath::SmoothStep(0.f, 1.0f, IslandMask);
+            IslandMask = FMath::Clamp(IslandMask, 0.f, 1.f);
+            OutHeights[x] = FMath::Clamp(OutHeights[x] * IslandMask, 0.f, 1.f);
+        }
+    }
+}
+
+void FOCGMapGenerator::ErosionPass(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap)
+{
+    if (!MapPreset->bErosion) return;
+
+    if (MapPreset->ErosionMethod == EOCGErosionMethod::PipeModel)
+    {
+        ApplyPipeModelErosion(MapPreset, InOutHeightMap);
+    }
+    else if (MapPreset->NumErosionIterations > 0)
+    {
+        ApplyDropletErosion(MapPreset, InOutHeightMap, MapPreset->bParallelErosion, Stream);
+    }
+}
+
+void FOCGMapGenerator::ApplyDropletErosion(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap, const bool bParallel,
+    FRandomStream& SerialStream)
+{
+    // 1. Initialize erosion brush which generates brush according to erosion radius
+    InitializeErosionBrush(MapPreset);
+    
+    // 2. Change Height Map from uint16 to world height float
+    TArray<float> HeightMapFloat = ScratchBuffers.Acquire<float>(InOutHeightMap.Num());
+    for (int i = 0; i < InOutHeightMap.Num(); ++i)
+    {
+        HeightMapFloat[i] = HeightMapToWorldHeight(InOutHeightMap[i]);
+    }
+
+    const float SeaLevelHeight = GetSeaLevelWorldHeight(MapPreset);
+
+    // 3. Main Erosion loop
+    if (bParallel)
+    {
+        SimulateDropletsParallel(MapPreset, HeightMapFloat, SeaLevelHeight);
+    }
+    else
+    {
+        const FIntRect MapBounds(FIntPoint::ZeroValue, MapPreset->MapResolution);
+        for (int i = 0; i < MapPreset->NumErosionIterations; ++i)
+        {
+            // initialize droplets
+            float PosX = SerialStream.RandRange(1.f, MapPreset->MapResolution.X - 2.f);
+            float PosY = SerialStream.RandRange(1.f, MapPreset->MapResolution.Y - 2.f);
+            SimulateDroplet(MapPreset, HeightMapFloat, MapBounds, PosX, PosY, SeaLevelHeight);
+        }
+    }
+
+    // 4. change world height map to height map (uint16)
+    StoreErodedHeightMap(HeightMapFloat, SeaLevelHeight, InOutHeightMap);
+    ScratchBuffers.Release(HeightMapFloat);
+}
+
+void FOCGMapGenerator::ApplyPipeModelErosion(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap)
+{
+    const FIntPoint MapSize = MapPreset->MapResolution;
+
+    // 1. Change Height Map from uint16 to world height float
+    TArray<float> HeightMapFloat = ScratchBuffers.Acquire<float>(InOutHeightMap.Num());
+    for (int i = 0; i < InOutHeightMap.Num(); ++i)
+    {
+        HeightMapFloat[i] = HeightMapToWorldHeight(InOutHeightMap[i]);
+    }
+
+    const float SeaLevelHeight = GetSeaLevelWorldHeight(MapPreset);
+
+    // 2. Simulate water flow on the whole grid
+    FOCGPipeErosionSettings Settings;
+    Settings.Iterations = MapPreset->PipeErosionIterations;
+    Settings.TimeStep = MapPreset->PipeTimeStep;
+    Settings.RainAmount = MapPreset->PipeRainAmount;
+    Settings.SedimentCapacity = MapPreset->PipeSedimentCapacity;
+    Settings.DissolveRate = MapPreset->PipeDissolveRate;
+    Settings.DepositRate = MapPreset->PipeDepositRate;
+    Settings.EvaporationRate = MapPreset->PipeEvaporationRate;
+    Settings.CellSize = MapPreset->LandscapeScale * 100.f;
+    Settings.SeaLevelHeight = SeaLevelHeight;
+    Settings.MaxThreads = MapPreset->MaxGenerationThreads;
+    OCGHydraulicErosion::ErodePipeModel(Settings, MapSize.X, MapSize.Y, HeightMapFloat);
+
+    // 3. change world height map to height map (uint16)
+    StoreErodedHeightMap(HeightMapFloat, SeaLevelHeight, InOutHeightMap);
+    ScratchBuffers.Release(HeightMapFloat);
+}
+
+void FOCGMapGenerator::StoreErodedHeightMap(const TArray<float>& InHeightMapFloat, const float SeaLevelHeight, TArray<uint16>& InOutHeightMap) const
+{
+    uint16 SeaHeight = WorldHeightToHeightMap(SeaLevelHeight);
+    for (int i = 0; i < InHeightMapFloat.Num(); ++i)
+    {
+        // erase height higher than original height map due to sediment
+        uint16 Height =  WorldHeightToHeightMap(InHeightMapFloat[i]);
+        uint16 NewHeight = FMath::Min(Height, InOutHeightMap[i]);
+        // prevent height from going under sea level due to erosion
+        if (InOutHeightMap[i] >= SeaHeight)
+            NewHeight = FMath::Max(NewHeight, SeaHeight);
+        InOutHeightMap[i] = FMath::Clamp(NewHeight, 0, 65535);
+    }
+}
+
+void FOCGMapGenerator::SimulateDropletsParallel(const UMapPreset* MapPreset, TArray<float>& InOutHeightMapFloat, const float SeaLevelHeight) const
+{
+    const FIntPoint MapSize = MapPreset->MapResolution;
+
+    // A droplet moves at most one pixel per step, so it never leaves its tile by more than Halo pixels.
+    // Its brush reaches ErosionRadius further and bilinear sampling one more pixel.
+    const int32 Halo = MapPreset->MaxDropletLifetime + 1;
+    const int32 Reach = Halo + MapPreset->ErosionRadius + 1;
+    // Tiles of the same color are one tile apart, so when a tile is at least twice the reach
+    // the droplets of same colored tiles never touch the same pixels and can run at the same time
+    const int32 TileSize = FMath::Max(2 * Reach, 64);
+    const FIntPoint NumTiles(FMath::DivideAndRoundUp(MapSize.X, TileSize), FMath::DivideAndRoundUp(MapSize.Y, TileSize));
+    const int32 TotalTiles = NumTiles.X * NumTiles.Y;
+    const int64 TotalPixels = static_cast<int64>(MapSize.X) * MapSize.Y;
+
+    // Droplets are distributed by tile area, the first droplet index of each tile is kept so counts add up exactly
+    TArray<int64> FirstDroplet;
+    FirstDroplet.SetNumUninitialized(TotalTiles + 1);
+    int64 CoveredPixels = 0;
+    for (int32 TileIndex = 0; TileIndex < TotalTiles; ++TileIndex)
+    {
+        FirstDroplet[TileIndex] = MapPreset->NumErosionIterations * CoveredPixels / TotalPixels;
+        const int32 TileX = TileIndex % NumTiles.X;
+        const int32 TileY = TileIndex / NumTiles.X;
+        const int64 TileWidth = FMath::Min(TileSize, MapSize.X - TileX * TileSize);
+        const int64 TileHeight = FMath::Min(TileSize, MapSize.Y - TileY * TileSize);
+        CoveredPixels += TileWidth * TileHeight;
+    }
+    FirstDroplet[TotalTiles] = MapPreset->NumErosionIterations;
+
+    // Tiles are processed in 4 color phases (2x2 checkerboard). Every tile owns a random stream seeded from the preset seed,
+    // and tiles of one phase never overlap, so the result does not depend on thread count or scheduling
+    for (int32 Color = 0; Color < 4; ++Color)
+    {
+        TArray<int32> PhaseTiles;
+        for (int32 TileIndex = 0; TileIndex < TotalTiles; ++TileIndex)
+        {
+            const int32 TileX = TileIndex % NumTiles.X;
+            const int32 TileY = TileIndex / NumTiles.X;
+            if ((TileX & 1) + 2 * (TileY & 1) == Color)
+            {
+                PhaseTiles.Add(TileIndex);
+            }
+        }
+
+        FOCGParallelUtils::ParallelForEach(PhaseTiles.Num(), MapPreset->MaxGenerationThreads, [&](const int32 PhaseTileIndex)
+        {
+            const int32 TileIndex = PhaseTiles[PhaseTileIndex];
+            const FIntPoint TileMin(TileIndex % NumTiles.X * TileSize, TileIndex / NumTiles.X * TileSize);
+            const FIntPoint TileMax(FMath::Min(TileMin.X + TileSize, MapSize.X), FMath::Min(TileMin.Y + TileSize, MapSize.Y));
+
+            const FIntRect DropletBounds(
+                FIntPoint(FMath::Max(TileMin.X - Halo, 0), FMath::Max(TileMin.Y - Halo, 0)),
+                FIntPoint(FMath::Min(TileMax.X + Halo, MapSize.X), FMath::Min(TileMax.Y + Halo, MapSize.Y)));
+
+            // Same spawn range as the serial pass, limited to this tile
+            const float SpawnMinX = FMath::Max(TileMin.X, 1);
+            const float SpawnMinY = FMath::Max(TileMin.Y, 1);
+            const float SpawnMaxX = FMath::Min(TileMax.X, MapSize.X - 2);
+            const float SpawnMaxY = FMath::Min(TileMax.Y, MapSize.Y - 2);
+
+            FRandomStream TileStream(static_cast<int32>(HashCombine(GetTypeHash(MapPreset->Seed), GetTypeHash(TileIndex))));
+            for (int64 i = FirstDroplet[TileIndex]; i < FirstDroplet[TileIndex + 1]; ++i)
+            {
+                float PosX = TileStream.RandRange(SpawnMinX, SpawnMaxX);
+                float PosY = TileStream.RandRange(SpawnMinY, SpawnMaxY);
+                SimulateDroplet(MapPreset, InOutHeightMapFloat, DropletBounds, PosX, PosY, SeaLevelHeight);
+            }
+        });
+    }
+}
+
+void FOCGMapGenerator::SimulateDroplet(const UMapPreset* MapPreset, TArray<float>& InOutHeightMapFloat, const FIntRect& Bounds,
+    float PosX, float PosY, const float SeaLevelHeight) const
+{
+    float LandscapeScale = MapPreset->LandscapeScale * 100.f;
+    float DirX = 0, DirY = 0;
+    float Speed = MapPreset->InitialSpeed;
+    float Water = MapPreset->InitialWaterVolume;
+    float Sediment = 0;
+
+    // simulate droplet
+    for (int Lifetime = 0; Lifetime < MapPreset->MaxDropletLifetime; ++Lifetime)
+    {
+        int32 NodeX = static_cast<int32>(PosX);
+        int32 NodeY = static_cast<int32>(PosY);
+
+        // if droplet is out of bounds end simulation
+        if (NodeX < Bounds.Min.X || NodeX >= Bounds.Max.X - 1 || NodeY < Bounds.Min.Y || NodeY >= Bounds.Max.Y - 1)
+        {
+            break;
+        }
+
+        // Calculate current pixels height and gradient
+        FVector2D Gradient;
+        float CurrentHeight = CalculateHeightAndGradient(MapPreset, InOutHeightMapFloat, LandscapeScale, PosX, PosY, Gradient);
+        
+        // Apply inertia and calculate droplets direction
+        DirX = (DirX * MapPreset->DropletInertia) - (Gradient.X * (1 - MapPreset->DropletInertia));
+        DirY = (DirY * MapPreset->DropletInertia) - (Gradient.Y * (1 - MapPreset->DropletInertia));
+        
+        // Normalize direction
+        float Len = FMath::Sqrt(DirX * DirX + DirY * DirY);
+        if (Len > KINDA_SMALL_NUMBER)
+        {
+            DirX /= Len;
+            DirY /= Len;
+        }
+        
+        // Move to new pixel using calculated direction
+        PosX += DirX;
+        PosY += DirY;
+        
+        if (PosX <= Bounds.Min.X || PosX >= Bounds.Max.X - 1 ||
+            PosY <= Bounds.Min.Y || PosY >= Bounds.Max.Y - 1)
+        {
+            break;
+        }
+        
+        // calculate height and gradient from new pixel
+        float NewHeight = CalculateHeightAndGradient(MapPreset, InOutHeightMapFloat, LandscapeScale, PosX, PosY, Gradient);
+        if (NewHeight <= SeaLevelHeight)
+            break;
+        float HeightDifference = NewHeight - CurrentHeight;
+        
+        // calculate sediment capacity
+        float SedimentCapacity = FMath::Max(-HeightDifference * Speed * Water * MapPreset->SedimentCapacityFactor, MapPreset->MinSedimentCapacity);
+
+        // apply sediment or erosion
+        if (Sediment > SedimentCapacity || HeightDifference > 0)
+        {
+            // sediment
+            float AmountToDeposit = (HeightDifference > 0) ? FMath::Min(Sediment, HeightDifference) : (Sediment - SedimentCapacity) * MapPreset->DepositSpeed;
+            Sediment -= AmountToDeposit;
+            
+            // apply sediment using pre-calculated erosion brush
+            ApplyErosionBrush(MapPreset, InOutHeightMapFloat, NodeX, NodeY, AmountToDeposit);
+        }
+        else
+        {
+            // erosion
+            float AmountToErode = FMath::Min((SedimentCapacity - Sediment), -HeightDifference) * MapPreset->ErodeSpeed;
+            
+            // apply erosion using pre-calculated erosion brush
+            ApplyErosionBrush(MapPreset, InOutHeightMapFloat, NodeX, NodeY, -AmountToErode);
+            Sediment += AmountToErode;
+        }
+        
+        // update droplets water amount and speed
+        Speed = FMath::Sqrt(FMath::Max(0.f, Speed * Speed - HeightDifference * MapPreset->Gravity));
+        Water *= (1.0f - MapPreset->EvaporateSpeed);
+    }
+}
+
+void FOCGMapGenerator::InitializeErosionBrush(const UMapPreset* MapPreset)
+{
+    // Brush is the same for every pixel, it only has to be rebuilt when radius or map width changes
+    if (CurrentErosionRadius == MapPreset->ErosionRadius && ErosionBrushMapWidth == MapPreset->MapResolution.X && ErosionBrushWeights.Num() > 0)
+    {
+        return;
+    }
+
+    const int32 Radius = MapPreset->ErosionRadius;
+    ErosionBrushOffsets.Reset();
+    ErosionBrushIndexOffsets.Reset();
+    ErosionBrushWeights.Reset();
+
+    float WeightSum = 0;
+    for (int32 y = -Radius; y <= Radius; y++)
+    {
+        for (int32 x = -Radius; x <= Radius; x++)
+        {
+            float Dist = FMath::Sqrt(static_cast<float>(x * x + y * y));
+            // Pixels on the radius would get zero weight, leave them out
+            if (Dist < Radius)
+            {
+                float Weight = 1.0f - (Dist / Radius);
+                WeightSum += Weight;
+                ErosionBrushOffsets.Add(FIntPoint(x, y));
+                ErosionBrushIndexOffsets.Add(y * MapPreset->MapResolution.X + x);
+                ErosionBrushWeights.Add(Weight);
+            }
+        }
+    }
+
+    // Normalize Weights so that weight sum of the brush is 1
+    for (float& Weight : ErosionBrushWeights)
+    {
+        Weight /= WeightSum;
+    }
+
+    CurrentErosionRadius = Radius;
+    ErosionBrushMapWidth = MapPreset->MapResolution.X;
+}
+
+void FOCGMapGenerator::ApplyErosionBrush(const UMapPreset* MapPreset, TArray<float>& InOutHeightMapFloat, const int32 NodeX, const int32 NodeY,
+    const float Amount) const
+{
+    const FIntPoint MapSize = MapPreset->MapResolution;
+    const int32 CenterIndex = NodeY * MapSize.X + NodeX;
+
+    // Whole brush is inside the map
+    if (NodeX >= CurrentErosionRadius && NodeX < MapSize.X - CurrentErosionRadius &&
+        NodeY >= CurrentErosionRadius && NodeY < MapSize.Y - CurrentErosionRadius)
+    {
+        for (int32 j = 0; j < ErosionBrushWeights.Num(); j++)
+        {
+            InOutHeightMapFloat[CenterIndex + ErosionBrushIndexOffsets[j]] += Amount * ErosionBrushWeights[j];
+        }
+        return;
+    }
+
+    // Near map border, skip pixels outside the map and renormalize the remaining weights so the full amount is applied
+    float WeightSum = 0;
+    for (int32 j = 0; j < ErosionBrushWeights.Num(); j++)
+    {
+        const FIntPoint Coord(NodeX + ErosionBrushOffsets[j].X, NodeY + ErosionBrushOffsets[j].Y);
+        if (Coord.X >= 0 && Coord.X < MapSize.X && Coord.Y >= 0 && Coord.Y < MapSize.Y)
+        {
+            WeightSum += ErosionBrushWeights[j];
+        }
+    }
+    if (WeightSum <= 0)
+        return;
+
+    for (int32 j = 0; j < ErosionBrushWeights.Num(); j++)
+    {
+        const FIntPoint Coord(NodeX + ErosionBrushOffsets[j].X, NodeY + ErosionBrushOffsets[j].Y);
+        if (Coord.X >= 0 && Coord.X < MapSize.X && Coord.Y >= 0 && Coord.Y < MapSize.Y)
+        {
+            InOutHeightMapFloat[CenterIndex + ErosionBrushIndexOffsets[j]] += Amount * (ErosionBrushWeights[j] / WeightSum);
+        }
+    }
+}
+
+float FOCGMapGenerator::CalculateHeightAndGradient(const UMapPreset* MapPreset, const TArray<float>& HeightMap, const float LandscapeScale, 
+    float PosX, float PosY,FVector2D& OutGradient) const
+{
+    int32 CoordX = static_cast<int32>(PosX);
+    int32 CoordY = static_cast<int32>(PosY);
+    
+    float x = PosX - CoordX;
+    float y = PosY - CoordY;
+
+    // 4 close indices
+    int32 Index_00 = CoordY * MapPreset->MapResolution.X + CoordX; // Closest index
+    int32 Index_10 = Index_00 + 1; // index of pixel at right
+    int32 Index_01 = Index_00 + MapPreset->MapResolution.X; // index of pixel at bottom
+    int32 Index_11 = Index_01 + 1; // index of pixel at bottom right
+
+    // Heights at each index
+    float Height_00 = HeightMap[Index_00];
+    float Height_10 = HeightMap[Index_10];
+    float Height_01 = HeightMap[Index_01];
+    float Height_11 = HeightMap[Index_11];
+
+    // Calculate Gradient
+    OutGradient.X = ((Height_10 - Height_00) * (1 - y) + (Height_11 - Height_01)) / LandscapeScale;
+    OutGradient.Y = ((Height_01 - Height_00) * (1 - x) + (Height_11 - Height_10)) / LandscapeScale;
+
+    // Calculate and return Height
+    return Height_00 * (1 - x) * (1 - y) + Height_10 * x * (1 - y) + Height_01 * (1 - x) * y + Height_11 * x * y;
+}
+
+void FOCGMapGenerator::ModifyLandscapeWithBiome(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap)
+{
+    if (!MapPreset->bModifyTerrainByBiome)
+        return;
+    TArray<float> MinHeights = ScratchBuffers.Acquire<float>(InOutHeightMap.Num());
+    TArray<float> BlurredMinHeights;
+
+    float HeightRange = MapPreset->MaxHeight - MapPreset->MinHeight;
+    
+    // Calculate each Biome region's minimum height
+    CalculateBiomeMinHeights(InOutHeightMap, MinHeights, MapPreset);
+    if (MapPreset->BiomeHeightBlendRadius > 0)
+    {
+        BlurredMinHeights = ScratchBuffers.Acquire<float>(InOutHeightMap.Num());
+        BlurBiomeMinHeights(BlurredMinHeights, MinHeights, MapPreset);
+        ScratchBuffers.Release(MinHeights);
+    }
+    else
+    {
+        BlurredMinHeights = MoveTemp(MinHeights);
+    }
+    float SeaLevel;
+    if (MapPreset->bContainWater)
+        SeaLevel = MapPreset->SeaLevel;
+    else
+        SeaLevel = 0.f;
+    float SeaLevelHeightF = SeaLevel * HeightRange + MapPreset->MinHeight;
+    uint16 SeaLevelHeight = WorldHeightToHeightMap(SeaLevelHeightF);
+
+    // Water keeps its height, layer 0 is the water biome
+    TArray<bool> KeepLayerHeight;
+    KeepLayerHeight.Add(true);
+    for (const FOCGBiomeSettings& Biome : MapPreset->Biomes)
+    {
+        KeepLayerHeight.Add(Biome.BiomeName == TEXT("Water"));
+    }
+
+    const FIntPoint MapSize = MapPreset->MapResolution;
+    FOCGParallelUtils::ParallelForRows(MapSize.Y, MapPreset->MaxGenerationThreads, [&](const int32 StartY, const int32 EndY)
+    {
+        TArray<float> RowNoise;
+        RowNoise.SetNumUninitialized(MapSize.X);
+        for (int32 y = StartY; y < EndY; ++y)
+        {
+            const int32 RowStart = y * MapSize.X;
+            ModifyHeightRow(MapPreset, y, KeepLayerHeight.GetData(), BlurredMinHeights.GetData() + RowStart, SeaLevelHeight, RowNoise.GetData(),
+                InOutHeightMap.GetData() + RowStart);
+        }
+    });
+    ScratchBuffers.Release(BlurredMinHeights);
+}
+
+void FOCGMapGenerator::ModifyHeightRow(const UMapPreset* MapPreset, const int32 InY, const bool* InKeepLayerHeight, const float* InBiomeMinHeights,
+    const uint16 SeaLevelHeight, float* NoiseScratch, uint16* InOutHeights) const
+{
+    const int32 Width = MapPreset->MapResolution.X;
+    const int32 RowStart = InY * Width;
+    const uint8* BiomeRow = BiomeIndexMap.GetData() + RowStart;
+    const float* MountainRatioRow = MountainRatioMap.GetData() + RowStart;
+    const float HeightRange = MapPreset->MaxHeight - MapPreset->MinHeight;
+
+    // Mountain noise of the whole row, 4 samples at a time
+    OCGNoise::PerlinRow(FVector2f::ZeroVector, MapPreset->BiomeNoiseScale, 0, InY, Width, NoiseScratch);
+
+    for (int32 x = 0; x < Width; ++x)
+    {
+        if (InKeepLayerHeight[BiomeRow[x]])
+            continue;
+        uint16 CurrentHeight = InOutHeights[x];
+        float MtoPRatio = MountainRatioRow[x];
+        uint16 BiomeMinHeight = WorldHeightToHeightMap(InBiomeMinHeights[x]);
+        // Plain Height of the biome region
+        uint16 TargetPlainHeight = FMath::Lerp(CurrentHeight, BiomeMinHeight, (1.0f - MtoPRatio) * MapPreset->PlainSmoothFactor);
+        // Generate Mountain Noise
+        float MaxAmplitude = (65535 - TargetPlainHeight) * LandscapeZScale / HeightRange / 128.f;
+        float Amplitude = MaxAmplitude * MapPreset->BiomeNoiseAmplitude;
+        float DetailNoise = NoiseScratch[x] * Amplitude + Amplitude;
+        float HeightToAdd = DetailNoise * HeightRange * 128.f / LandscapeZScale;
+        float MountainHeight = FMath::Clamp(HeightToAdd + TargetPlainHeight, 0, 65535);
+
+        // Calculate final biome height by lerp
+        uint16 NewHeight = FMath::Lerp(TargetPlainHeight, MountainHeight, MtoPRatio);
+        NewHeight = FMath::Clamp(FMath::Max(NewHeight, SeaLevelHeight), 0, 65535);
+        InOutHeights[x] = NewHeight;
+    }
+}
+
+void FOCGMapGenerator::CalculateBiomeMinHeights(const TArray<uint16>& InHeightMap, TArray<float>& OutMinHeights, const UMapPreset* MapPreset)
+{
+    FIntPoint MapSize = MapPreset->MapResolution;
+    const int32 TotalPixels = MapSize.X * MapSize.Y;
+    OutMinHeights.SetNumUninitialized(TotalPixels);
+
+    // Every 4-connected area of the same biome is one region
+    BiomeRegions.Build(BiomeIndexMap, InHeightMap, MapSize, MapPreset->MaxGenerationThreads);
+
+    const TArray<FOCGRegion>& Regions = BiomeRegions.GetRegions();
+    TArray<float> RegionMinHeight;
+    RegionMinHeight.SetNumUninitialized(Regions.Num());
+    for (int32 RegionIndex = 0; RegionIndex < Regions.Num(); ++RegionIndex)
+    {
+        RegionMinHeight[RegionIndex] = HeightMapToWorldHeight(Regions[RegionIndex].MinHeight);
+    }
+
+    const TArray<int32>& RegionMap = BiomeRegions.GetRegionMap();
+    FOCGParallelUtils::ParallelForRows(MapSize.Y, MapPreset->MaxGenerationThreads, [&](const int32 StartY, const int32 EndY)
+    {
+        for (int32 i = StartY * MapSize.X; i < EndY * MapSize.X; ++i)
+        {
+            OutMinHeights[i] = RegionMinHeight[RegionMap[i]];
+        }
+    });
+}
+
+void FOCGMapGenerator::BlurBiomeMinHeights(TArray<float>& OutMinHeights, const TArray<float>& InMinHeights, const UMapPreset* MapPreset)
+{
+    int32 BlendRadius = MapPreset->BiomeHeightBlendRadius;
+    FIntPoint MapSize = MapPreset->MapResolution;
+    int32 TotalPixels = MapSize.X * MapSize.Y;
+    OutMinHeights.SetNumUninitialized(TotalPixels);
+    FOCGBlurScratch BlurScratch = AcquireBlurScratch(TotalPixels);
+    OCGBlur::BoxBlur(InMinHeights.GetData(), OutMinHeights.GetData(), MapSize.X, MapSize.Y, BlendRadius, EOCGBlurEdgeMode::Clamp,
+        MapPreset->MaxGenerationThreads, &BlurScratch);
+    ReleaseBlurScratch(BlurScratch);
+}
+
+void FOCGMapGenerator::GetMaxMinHeight(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap)
+{
+    int32 TotalPixel = MapPreset->MapResolution.X * MapPreset->MapResolution.Y;
+    float Max = MapPreset->MinHeight;
+    float Min = MapPreset->MaxHeight;
+    for (int32 i=0; i < TotalPixel; i++)
+    {
+        const float WorldHeight = HeightMapToWorldHeight(InHeightMap[i]);
+        if (WorldHeight > Max)
+            Max = WorldHeight;
+        if (WorldHeight < Min)
+            Min = WorldHeight;
+    }
+    CurMaxHeight = Max;
+    CurMinHeight = Min;
+}
+
+void FOCGMapGenerator::SmoothHeightMap(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap)
+{
+    if (!MapPreset->bSmoothHeight)
+        return;
+    
+    ApplySpikeSmooth(MapPreset, InOutHeightMap);
+    
+    TArray<uint16> BlurredHeightMap;
+    
+    ApplyGaussianBlur(MapPreset, InOutHeightMap, BlurredHeightMap);
+
+    MedianSmooth(MapPreset, InOutHeightMap);
+}
+
+void FOCGMapGenerator::ApplyGaussianBlur(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap,
+    TArray<uint16>& OutBlurredMap)
+{
+    int32 Radius = MapPreset->GaussianBlurRadius;
+
+    FIntPoint MapSize = MapPreset->MapResolution;
+    int32 TotalPixels = MapSize.X * MapSize.Y;
+
+    OutBlurredMap.SetNumUninitialized(TotalPixels);
+
+    // Sigma equal to the radius keeps the falloff of the original kernel
+    // GaussianBlurRadius is clamped to 25, short enough for the exact kernel. Longer radii would use ApproximateGaussianBlur
+    FOCGBlurScratch BlurScratch = AcquireBlurScratch(TotalPixels);
+    OCGBlur::GaussianBlur(InOutHeightMap.GetData(), OutBlurredMap.GetData(), MapSize.X, MapSize.Y, Radius, static_cast<float>(Radius),
+        EOCGBlurEdgeMode::Clamp, MapPreset->MaxGenerationThreads, &BlurScratch);
+    ReleaseBlurScratch(BlurScratch);
+
+    InOutHeightMap = OutBlurredMap;
+}
+
+void FOCGMapGenerator::ApplySpikeSmooth(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap)
+{
+    if (!MapPreset->bSmoothBySlope)
+        return;
+    
+    FIntPoint MapSize = MapPreset->MapResolution;
+
+    const int32 KernelRadius = MapPreset->GaussianBlurRadius / 2.f;
+    const int32 KernelSize = (2 * KernelRadius + 1);
+    
+    const float MaxAllowedSlope = FMath::Tan(FMath::DegreesToRadians(MapPreset->MaxSlopeAngle));
+
+    int32 Step = FMath::Max(KernelRadius / 2.f, 1);
+    
+    for (int Iteration=0; Iteration<MapPreset->SmoothingIteration; Iteration++)
+    {
+        int32 SmoothedRegion = 0;
+        TArray<uint16> OriginalHeightMap = InOutHeightMap; 
+        for (int32 y=KernelRadius; y<MapSize.Y-KernelRadius; y += Step)
+        {
+            for (int32 x=KernelRadius; x<MapSize.X-KernelRadius; x += Step)
+            {
+                ProcessPlane(MapPreset, x, y, MapSize, KernelRadius, KernelSize, MaxAllowedSlope,
+                SmoothedRegion, OriginalHeightMap, InOutHeightMap);
+            }
+        }
+        if (SmoothedRegion == 0)
+            break;
+    }
+}
+
+void FOCGMapGenerator::ProcessPlane(const UMapPreset* MapPreset, int32 x, int32 y, const FIntPoint MapSize,
+    const int32 KernelRadius, const int32 KernelSize, const float MaxAllowedSlope,
+    int32& SmoothedRegion, TArray<uint16>& InOriginalHeightMap, TArray<uint16>& OutHeightMap)
+{
+    float LandscapeScale = MapPreset->LandscapeScale * 100.f;
+
+    const float Length = KernelSize * LandscapeScale;
+    
+    float TLHeight = HeightMapToWorldHeight(InOriginalHeightMap[(y-KernelRadius)*MapSize.X + (x-KernelRadius)]);
+    float TRHeight = HeightMapToWorldHeight(InOriginalHeightMap[(y-KernelRadius)*MapSize.X + (x+KernelRadius)]);
+    float BLHeight = HeightMapToWorldHeight(InOriginalHeightMap[(y+KernelRadius)*MapSize.X + (x-KernelRadius)]);
+    float BRHeight = HeightMapToWorldHeight(InOriginalHeightMap[(y+KernelRadius)*MapSize.X + (x+KernelRadius)]);
+
+    float TopSlope = (TRHeight - TLHeight)/Length;
+    float BottomSlope = (BRHeight - BLHeight)/Length;
+    float RightSlope = (BRHeight - TRHeight)/Length;
+    float LeftSlope = (BLHeight - TLHeight)/Length;
+
+    float Slope_X = (BottomSlope + TopSlope)/2.f;
+    float Slope_Y = (RightSlope + LeftSlope)/2.f;
+
+    const float CurrentSlope = FMath::Sqrt(Slope_X * Slope_X + Slope_Y * Slope_Y);
+    
+    if (CurrentSlope > MaxAllowedSlope)
+    {
+        SmoothedRegion++;
+
+        float AverageHeight = (TLHeight + TRHeight + BRHeight + BLHeight)/4.f;
+        FVector Plane = {Slope_X, Slope_Y, AverageHeight};
+
+        float CorrectionFactor = MaxAllowedSlope / CurrentSlope;
+        float CorrectedSlope_X = Slope_X * CorrectionFactor;
+        float CorrectedSlope_Y = Slope_Y * CorrectionFactor;
+
+        for (int32 ky = -KernelRadius; ky<=KernelRadius; ky++)
+        {
+            for (int32 kx = -KernelRadius; kx<=KernelRadius; kx++)
+            {
+                int32 Index = (y+ky)*MapSize.X + (x+kx);
+                float OriginalWorldHeight = HeightMapToWorldHeight(InOriginalHeightMap[Index]);
+                float CurrentHeight = Plane.X * kx * LandscapeScale + Plane.Y * ky * LandscapeScale + Plane.Z;
+                float CorrectedHeight = CorrectedSlope_X * kx * LandscapeScale + CorrectedSlope_Y * ky * LandscapeScale + Plane.Z;
+                float NewWorldHeight = OriginalWorldHeight + (CorrectedHeight - CurrentHeight);
+                NewWorldHeight = FMath::Clamp(NewWorldHeight, MapPreset->MinHeight + ZOffset, MapPreset->MaxHeight + ZOffset);
+                uint16 NewHeight = WorldHeightToHeightMap(NewWorldHeight);
+                uint16 OriginalHeight = WorldHeightToHeightMap(OriginalWorldHeight);
+
+                OutHeightMap[Index] = FMath::Lerp(OriginalHeight, NewHeight, MapPreset->SmoothingStrength);
+            }
+        }
+    }
+}
+
+void FOCGMapGenerator::GenerateTempMap(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap, TArray<uint16>& OutTempMap)
+{
+    const FIntPoint CurResolution = MapPreset->MapResolution;
+    
+    TArray<float> TempMapFloat = ScratchBuffers.Acquire<float>(CurResolution.X * CurResolution.Y);
+
+    float GlobalMinTemp = TNumericLimits<float>::Max();
+    float GlobalMaxTemp = TNumericLimits<float>::Lowest();
+    FCriticalSection MinMaxLock;
+
+    FOCGParallelUtils::ParallelForRows(CurResolution.Y, MapPreset->MaxGenerationThreads, [&](const int32 StartY, const int32 EndY)
+    {
+        TArray<float> NoiseRow;
+        NoiseRow.SetNumUninitialized(CurResolution.X);
+        float BandMinTemp = TNumericLimits<float>::Max();
+        float BandMaxTemp = TNumericLimits<float>::Lowest();
+
+        for (int32 y = StartY; y < EndY; ++y)
+        {
+            const int32 RowStart = y * CurResolution.X;
+            CalculateTemperatureRow(MapPreset, y, &InHeightMap[RowStart], NoiseRow.GetData(), &TempMapFloat[RowStart], BandMinTemp, BandMaxTemp);
+        }
+
+        FScopeLock Lock(&MinMaxLock);
+        GlobalMinTemp = FMath::Min(GlobalMinTemp, BandMinTemp);
+        GlobalMaxTemp = FMath::Max(GlobalMaxTemp, BandMaxTemp);
+    });
+
+    QuantizeTempMap(MapPreset, TempMapFloat, GlobalMinTemp, GlobalMaxTemp, OutTempMap);
+    ScratchBuffers.Release(TempMapFloat);
+}
+
+void FOCGMapGenerator::GenerateHeightAndTempMap(const UMapPreset* MapPreset, const FIntPoint CurMapResolution, TArray<uint16>& OutHeightMap,
+    TArray<uint16>& OutTempMap)
+{
+    OutHeightMap.SetNumUninitialized(CurMapResolution.X * CurMapResolution.Y);
+
+    TArray<float> TempMapFloat = ScratchBuffers.Acquire<float>(CurMapResolution.X * CurMapResolution.Y);
+
+    float GlobalMinTemp = TNumericLimits<float>::Max();
+    float GlobalMaxTemp = TNumericLimits<float>::Lowest();
+    FCriticalSection MinMaxLock;
+
+    // Height and temperature of a row are computed while the row is still in cache,
+    // the height map is written once and never read back by a separate temperature sweep
+    FOCGParallelUtils::ParallelForRows(CurMapResolution.Y, MapPreset->MaxGenerationThreads, [&](const int32 StartY, const int32 EndY)
+    {
+        TArray<float> RowHeights;
+        RowHeights.SetNumUninitialized(CurMapResolution.X);
+        TArray<float> RowScratch;
+        RowScratch.SetNumUninitialized(CurMapResolution.X * 2);
+        float BandMinTemp = TNumericLimits<float>::Max();
+        float BandMaxTemp = TNumericLimits<float>::Lowest();
+
+        for (int32 y = StartY; y < EndY; ++y)
+        {
+            const int32 RowStart = y * CurMapResolution.X;
+            CalculateHeightRow(MapPreset, y, RowHeights.GetData(), RowScratch.GetData());
+            for (int32 x = 0; x < CurMapResolution.X; ++x)
+            {
+                // Same quantization as GenerateHeightMap so both paths give the same maps
+                const float NormalizedHeight = RowHeights[x] * 65535.f;
+                OutHeightMap[RowStart + x] = FMath::Clamp(FMath::RoundToInt(NormalizedHeight), 0, 65535);
+            }
+            CalculateTemperatureRow(MapPreset, y, &OutHeightMap[RowStart], RowScratch.GetData(), &TempMapFloat[RowStart], BandMinTemp, BandMaxTemp);
+        }
+
+        FScopeLock Lock(&MinMaxLock);
+        GlobalMinTemp = FMath::Min(GlobalMinTemp, BandMinTemp);
+        GlobalMaxTemp = FMath::Max(GlobalMaxTemp, BandMaxTemp);
+    });
+
+    QuantizeTempMap(MapPreset, TempMapFloat, GlobalMinTemp, GlobalMaxTemp, OutTempMap);
+    ScratchBuffers.Release(TempMapFloat);
+}
+
+void FOCGMapGenerator::CalculateTemperatureRow(const UMapPreset* MapPreset, const int32 InY, const uint16* InHeightRow, float* NoiseScratch,
+    float* OutTemps, float& InOutMinTemp, float& InOutMaxTemp) const
+{
+    const int32 Width = MapPreset->MapResolution.X;
+    const float TempRange = MapPreset->MaxTemp - MapPreset->MinTemp;
+
+    const float SeaLevelHeight = GetSeaLevelWorldHeight(MapPreset);
+
+    // Generate base temperature map with low frequency noise
+    OCGNoise::PerlinRow(FVector2f(PlainNoiseOffset), MapPreset->TemperatureNoiseScale, 0, InY, Width, NoiseScratch);
+
+    for (int32 x = 0; x < Width; ++x)
+    {
+        float TempNoiseAlpha = NoiseScratch[x] * 0.5f + 0.5f;
+        
+        float BaseTemp = FMath::Lerp(MapPreset->MinTemp, MapPreset->MaxTemp, TempNoiseAlpha);
+
+        // Decrease temperature by altitude
+        const float WorldHeight = HeightMapToWorldHeight(InHeightRow[x]);
+        if (WorldHeight > SeaLevelHeight)
+        {
+            BaseTemp -= ((WorldHeight - SeaLevelHeight) / 1000.0f) * MapPreset->TempDropPer1000Units;
+        }
+
+        float NormalizedBaseTemp = (BaseTemp - MapPreset->MinTemp) / TempRange;
+
+        BaseTemp = MapPreset->MinTemp + NormalizedBaseTemp * TempRange;
+        // Calculate final temperature
+        const float FinalTemp = FMath::Clamp(BaseTemp, MapPreset->MinTemp, MapPreset->MaxTemp);
+        
+        OutTemps[x] = FinalTemp;
+        
+        if (FinalTemp < InOutMinTemp) InOutMinTemp = FinalTemp;
+        if (FinalTemp > InOutMaxTemp) InOutMaxTemp = FinalTemp;
+    }
+}
+
+void FOCGMapGenerator::QuantizeTempMap(const UMapPreset* MapPreset, const TArray<float>& InTempMapFloat, const float GlobalMinTemp,
+    const float GlobalMaxTemp, TArray<uint16>& OutTempMap)
+{
+    OutTempMap.SetNumUninitialized(InTempMapFloat.Num());
+
+    CachedGlobalMinTemp = GlobalMinTemp;
+    CachedGlobalMaxTemp = GlobalMaxTemp;
+
+    // convert float temperature to uint16
+    float TempRange = GlobalMaxTemp - GlobalMinTemp;
+    if (TempRange < KINDA_SMALL_NUMBER)
+    {
+        TempRange = 1.0f; // prevent dividing by 0
+    }
+
+    const int32 Width = MapPreset->MapResolution.X;
+    FOCGParallelUtils::ParallelForRows(MapPreset->MapResolution.Y, MapPreset->MaxGenerationThreads, [&](const int32 StartY, const int32 EndY)
+    {
+        for (int32 i = StartY * Width; i < EndY * Width; ++i)
+        {
+            // Normalize temperature to 0~1
+            const float NormalizedTemp = (InTempMapFloat[i] - GlobalMinTemp) / TempRange;
+            
+            // convert 0~1 to 0~65535
+            OutTempMap[i] = static_cast<uint16>(NormalizedTemp * 65535.0f);
+        }
+    });
+
+    // Export as png
+    ExportMap(MapPreset, OutTempMap, "TempMap.png");
+}
+
+void FOCGMapGenerator::GenerateHumidityMap(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap, const TArray<uint16>& InTempMap,
+	TArray<uint16>& OutHumidityMap)
+{
+    const FIntPoint CurResolution = MapPreset->MapResolution;
+    if (OutHumidityMap.Num() != CurResolution.X * CurResolution.Y)
+    {
+        OutHumidityMap.SetNumUninitialized(CurResolution.X * CurResolution.Y);
+    }
+    
+    float SeaLevelWorldHeight;
+    if (MapPreset->bContainWater)
+    {
+        SeaLevelWorldHeight = MapPreset->MinHeight + MapPreset->SeaLevel * (MapPreset->MaxHeight - MapPreset->MinHeight);
+    }
+    else
+    {
+        SeaLevelWorldHeight = MapPreset->MinHeight;
+    }
+    
+    const int32 NumPixels = CurResolution.X * CurResolution.Y;
+    const int32 MaxThreads = MapPreset->MaxGenerationThreads;
+
+    // 1. Find water pixels
+    TArray<bool> IsWater;
+    IsWater.SetNumUninitialized(NumPixels);
+    FOCGParallelUtils::ParallelForRows(CurResolution.Y, MaxThreads, [&](const int32 StartY, const int32 EndY)
+    {
+        for (int32 i = StartY * CurResolution.X; i < EndY * CurResolution.X; ++i)
+        {
+            IsWater[i] = HeightMapToWorldHeight(InHeightMap[i]) <= SeaLevelWorldHeight;
+        }
+    });
+
+    // Euclidean distance to the closest water pixel
+    TArray<float> DistanceToWater = ScratchBuffers.Acquire<float>(NumPixels);
+    OCGDistanceTransform::EuclideanDistance(IsWater, CurResolution.X, CurResolution.Y, MaxThreads, DistanceToWater);
+
+    // 2. Calculate humidity based on distance and temperature
+    TArray<float> HumidityMapFloat = ScratchBuffers.Acquire<float>(NumPixels);
+
+    float GlobalMinHumidity = TNumericLimits<float>::Max();
+    float GlobalMaxHumidity = TNumericLimits<float>::Lowest();
+    FCriticalSection MinMaxLock;
+
+    FOCGParallelUtils::ParallelForRows(CurResolution.Y, MaxThreads, [&](const int32 StartY, const int32 EndY)
+    {
+        float BandMinHumidity = TNumericLimits<float>::Max();
+        float BandMaxHumidity = TNumericLimits<float>::Lowest();
+
+        for (int32 i = StartY * CurResolution.X; i < EndY * CurResolution.X; ++i)
+        {
+            float FinalHumidity = 0.0f;
+
+            if (DistanceToWater[i] == 0)
+            {
+                // water pixel's humidity is always 1
+                FinalHumidity = 1.0f;
+            }
+            else
+            {
+                // decide humidity based on distance
+                const float HumidityFromDistance = FMath::Exp(-DistanceToWater[i] * MapPreset->MoistureFalloffRate);
+
+                // apply temperature affect
+                const float NormalizedTemp = static_cast<float>(InTempMap[i]) / 65535.0f;
+                FinalHumidity = HumidityFromDistance * (1.0f - (NormalizedTemp * MapPreset->TemperatureInfluenceOnHumidity));
+            }
+
+            FinalHumidity = FMath::Clamp(FinalHumidity, 0.0f, 1.0f);
+
+            HumidityMapFloat[i] = FinalHumidity;
+
+            if (FinalHumidity < BandMinHumidity) BandMinHumidity = FinalHumidity;
+            if (FinalHumidity > BandMaxHumidity) BandMaxHumidity = FinalHumidity;
+        }
+
+        FScopeLock Lock(&MinMaxLock);
+        GlobalMinHumidity = FMath::Min(GlobalMinHumidity, BandMinHumidity);
+        GlobalMaxHumidity = FMath::Max(GlobalMaxHumidity, BandMaxHumidity);
+    });
+
+    ScratchBuffers.Release(DistanceToWater);
+
+    CachedGlobalMinHumidity = GlobalMinHumidity;
+    CachedGlobalMaxHumidity = GlobalMaxHumidity;
+    
+    // 3. convert to uint16 data
+    float HumidityRange = GlobalMaxHumidity - GlobalMinHumidity;
+    if (HumidityRange < KINDA_SMALL_NUMBER) HumidityRange = 1.0f;
+
+    FOCGParallelUtils::ParallelForRows(CurResolution.Y, MaxThreads, [&](const int32 StartY, const int32 EndY)
+    {
+        for (int32 i = StartY * CurResolution.X; i < EndY * CurResolution.X; ++i)
+        {
+            const float NormalizedHumidity = (HumidityMapFloat[i] - GlobalMinHumidity) / HumidityRange;
+            OutHumidityMap[i] = static_cast<uint16>(NormalizedHumidity * 65535.0f);
+        }
+    });
+    ScratchBuffers.Release(HumidityMapFloat);
+
+    ExportMap(MapPreset, OutHumidityMap, "HumidityMap.png");
+}
+
+void FOCGMapGenerator::DecideBiome(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap, const TArray<uint16>& InTempMap,
+    const TArray<uint16>& InHumidityMap, TArray<const FOCGBiomeSettings*>& OutBiomeMap, bool bExportMap, bool bBuildMountainRatio)
+{
+    const FIntPoint CurResolution = MapPreset->MapResolution;
+    
+    BiomeColorMap.SetNumUninitialized(CurResolution.X * CurResolution.Y);
+    BiomeIndexMap.SetNumUninitialized(CurResolution.X * CurResolution.Y);
+    OutBiomeMap.SetNumUninitialized(CurResolution.X * CurResolution.Y);
+
+    // Water biome is the first layer, followed by every biome of the preset
+    WeightLayers.Init(MapPreset->Biomes.Num() + 1, CurResolution);
+
+    uint16 SeaLevelHeight;
+    if (MapPreset->bContainWater)
+    {
+        SeaLevelHeight = 65535 * MapPreset->SeaLevel;
+    }
+    else
+    {
+        SeaLevelHeight = 0;
+    }
+
+    AssignBiomes(MapPreset, InHeightMap, InTempMap, InHumidityMap, SeaLevelHeight, OutBiomeMap);
+
+    if (bExportMap)
+        ExportMap(MapPreset, BiomeColorMap, "BiomeMap1.png");
+    BlendBiome(MapPreset, bBuildMountainRatio);
+}
+
+void FOCGMapGenerator::FinalizeBiome(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap, const TArray<uint16>& InTempMap,
+    const TArray<uint16>& InHumidityMap, TArray<const FOCGBiomeSettings*>& OutBiomeMap)
+{
+    if (!MapPreset->bContainWater)
+        return;
+
+    uint16 SeaLevelHeight = 65535 * MapPreset->SeaLevel;
+
+    AssignBiomes(MapPreset, InHeightMap, InTempMap, InHumidityMap, SeaLevelHeight, OutBiomeMap);
+
+    ExportMap(MapPreset, BiomeColorMap, "BiomeMap1.png");
+    BlendBiome(MapPreset, false);
+
+    ExportWeightLayers(MapPreset, WeightLayers);
+}
+
+void FOCGMapGenerator::BuildBiomeLookupTable(const UMapPreset* MapPreset, TArray<uint8>& OutLookupTable) const
+{
+    OutLookupTable.Init(0, BiomeLookupTableSize * BiomeLookupTableSize);
+
+    // Layer index is stored in a byte and layer 0 is the water biome
+    const int32 NumBiomes = FMath::Min(MapPreset->Biomes.Num(), 255);
+    if (NumBiomes < MapPreset->Biomes.Num())
+    {
+        UE_LOG(LogOCGModule, Warning, TEXT("Only the first %d biomes are used, %d are defined"), NumBiomes, MapPreset->Biomes.Num());
+    }
+
+    float TotalWeight = 0.f;
+    for (int32 BiomeIndex = 0; BiomeIndex < NumBiomes; ++BiomeIndex)
+    {
+        TotalWeight += MapPreset->Biomes[BiomeIndex].Weight;
+    }
+    const float TempRange = MapPreset->MaxTemp - MapPreset->MinTemp;
+
+    // Each entry is evaluated at the center of the uint16 range it covers
+    const float BucketSize = 65536.f / BiomeLookupTableSize;
+    for (int32 TempBucket = 0; TempBucket < BiomeLookupTableSize; ++TempBucket)
+    {
+        const float NormalizedTemp = (TempBucket * BucketSize + BucketSize * 0.5f) / 65535.f;
+        const float Temp = FMath::Lerp(CachedGlobalMinTemp, CachedGlobalMaxTemp, NormalizedTemp);
+
+        for (int32 HumidityBucket = 0; HumidityBucket < BiomeLookupTableSize; ++HumidityBucket)
+        {
+            const float NormalizedHumidity = (HumidityBucket * BucketSize + BucketSize * 0.5f) / 65535.f;
+            const float Humidity = FMath::Lerp(CachedGlobalMinHumidity, CachedGlobalMaxHumidity, NormalizedHumidity);
+
+            float MinDist = TNumericLimits<float>::Max();
+            uint8 ClosestLayer = 0;
+            for (int32 BiomeIndex = 1; BiomeIndex <= NumBiomes; ++BiomeIndex)
+            {
+                const FOCGBiomeSettings& BiomeSettings = MapPreset->Biomes[BiomeIndex - 1];
+                float TempDiff = FMath::Abs(BiomeSettings.Temperature - Temp) / TempRange;
+                float HumidityDiff = FMath::Abs(BiomeSettings.Humidity - Humidity);
+                float Weight = 1.f - BiomeSettings.Weight / TotalWeight;
+                float Dist = FVector2D(TempDiff, HumidityDiff).Length() * Weight;
+                if (Dist < MinDist)
+                {
+                    MinDist = Dist;
+                    ClosestLayer = static_cast<uint8>(BiomeIndex);
+                }
+            }
+            OutLookupTable[TempBucket * BiomeLookupTableSize + HumidityBucket] = ClosestLayer;
+        }
+    }
+}
+
+void FOCGMapGenerator::AssignBiomes(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap, const TArray<uint16>& InTempMap,
+    const TArray<uint16>& InHumidityMap, const uint16 SeaLevelHeight, TArray<const FOCGBiomeSettings*>& OutBiomeMap)
+{
+    const FIntPoint CurResolution = MapPreset->MapResolution;
+
+    TArray<uint8> LookupTable;
+    BuildBiomeLookupTable(MapPreset, LookupTable);
+
+    // Settings and color of every layer, layer 0 is the water biome
+    TArray<const FOCGBiomeSettings*> LayerBiomes;
+    TArray<FColor> LayerColors;
+    LayerBiomes.Add(&MapPreset->WaterBiome);
+    LayerColors.Add(MapPreset->WaterBiome.Color.ToFColor(true));
+    for (const FOCGBiomeSettings& Biome : MapPreset->Biomes)
+    {
+        LayerBiomes.Add(&Biome);
+        LayerColors.Add(Biome.Color.ToFColor(true));
+    }
+
+    FOCGParallelUtils::ParallelForRows(CurResolution.Y, MapPreset->MaxGenerationThreads, [&](const int32 StartY, const int32 EndY)
+    {
+        for (int32 Index = StartY * CurResolution.X; Index < EndY * CurResolution.X; ++Index)
+        {
+            uint8 LayerIndex = 0;
+            // Water Biome is first layer
+            if (InHeightMap[Index] >= SeaLevelHeight)
+            {
+                const int32 TempBucket = InTempMap[Index] >> BiomeLookupBucketShift;
+                const int32 HumidityBucket = InHumidityMap[Index] >> BiomeLookupBucketShift;
+                LayerIndex = LookupTable[TempBucket * BiomeLookupTableSize + HumidityBucket];
+            }
+
+            BiomeIndexMap[Index] = LayerIndex;
+            OutBiomeMap[Index] = LayerBiomes[LayerIndex];
+            BiomeColorMap[Index] = LayerColors[LayerIndex];
+        }
+    });
+}
+
+void FOCGMapGenerator::MedianSmooth(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap)
+{
+    if (!MapPreset->bSmoothByMediumHeight)
+        return;
+    const int32 Radius = MapPreset->MedianSmoothRadius;
+    const FIntPoint MapSize = MapPreset->MapResolution;
+
+    const TArray<uint16> OriginalHeightMap = MoveTemp(InOutHeightMap);
+    OCGMedianFilter::MedianFilter(OriginalHeightMap, InOutHeightMap, MapSize.X, MapSize.Y, Radius, MapPreset->MaxGenerationThreads);
+}
+
+FOCGBlurScratch FOCGMapGenerator::AcquireBlurScratch(const int32 NumPixels)
+{
+    FOCGBlurScratch Scratch;
+    Scratch.Horizontal = ScratchBuffers.Acquire<float>(NumPixels);
+    Scratch.Transposed = ScratchBuffers.Acquire<float>(NumPixels);
+    return Scratch;
+}
+
+void FOCGMapGenerator::ReleaseBlurScratch(FOCGBlurScratch& Scratch)
+{
+    ScratchBuffers.Release(Scratch.Horizontal);
+    ScratchBuffers.Release(Scratch.Transposed);
+}
+
+void FOCGMapGenerator::BlendBiome(const UMapPreset* MapPreset, const bool bBuildMountainRatio)
+{
+    const FIntPoint CurResolution = MapPreset->MapResolution;
+
+    // Every layer blurs through the same scratch buffers
+    FOCGBlurScratch BlurScratch = AcquireBlurScratch(CurResolution.X * CurResolution.Y);
+    for (int32 LayerIndex = 0; LayerIndex < WeightLayers.Num(); ++LayerIndex)
+    {
+        // unblurred weight is 255 where the pixel belongs to this layer, then blurred in place
+        uint8* Layer = WeightLayers.GetLayerData(LayerIndex);
+        FOCGParallelUtils::ParallelForRows(CurResolution.Y, MapPreset->MaxGenerationThreads, [&](const int32 StartY, const int32 EndY)
+        {
+            for (int32 i = StartY * CurResolution.X; i < EndY * CurResolution.X; ++i)
+            {
+                Layer[i] = BiomeIndexMap[i] == LayerIndex ? 255 : 0;
+            }
+        });
+
+        int32 BlendRadius = (LayerIndex == 0) ? MapPreset->WaterBlendRadius : MapPreset->BiomeBlendRadius;
+        OCGBlur::BoxBlur(Layer, Layer, CurResolution.X, CurResolution.Y, BlendRadius, EOCGBlurEdgeMode::Clamp, MapPreset->MaxGenerationThreads,
+            &BlurScratch);
+    }
+    ReleaseBlurScratch(BlurScratch);
+    
+    // make sure each pixel's weight sum is equal to 255
+    // The blended mountain ratio is accumulated from the final weights in the same pass
+    if (bBuildMountainRatio)
+    {
+        MountainRatioMap.SetNumUninitialized(CurResolution.X * CurResolution.Y);
+    }
+    else
+    {
+        MountainRatioMap.Empty();
+    }
+    FOCGParallelUtils::ParallelForRows(CurResolution.Y, MapPreset->MaxGenerationThreads, [&](const int32 StartY, const int32 EndY)
+    {
+        for (int32 i = StartY * CurResolution.X; i < EndY * CurResolution.X; ++i)
+        {
+            float TotalWeight = 0;
+            for (int32 LayerIndex = 0; LayerIndex < WeightLayers.Num(); ++LayerIndex)
+            {
+                TotalWeight += WeightLayers.GetLayerData(LayerIndex)[i];
+            }
+            
+            if (TotalWeight > 0)
+            {
+                float NormalizationFactor = 255.f / TotalWeight;
+                for (int32 LayerIndex = 0; LayerIndex < WeightLayers.Num(); ++LayerIndex)
+                {
+                    uint8& Weight = WeightLayers.GetLayerData(LayerIndex)[i];
+                    Weight = FMath::RoundToInt(Weight * NormalizationFactor);
+                }
+            }
+
+            if (!bBuildMountainRatio)
+                continue;
+
+            // Water layer has no mountain ratio
+            float MountainRatio = 0.f;
+            for (int32 LayerIndex = 1; LayerIndex < WeightLayers.Num(); ++LayerIndex)
+            {
+                float LayerWeight = WeightLayers.GetLayerData(LayerIndex)[i] / 255.f;
+                if (LayerWeight <= 0.f)
+                    continue;
+                MountainRatio += MapPreset->Biomes[LayerIndex - 1].MountainRatio * LayerWeight;
+            }
+            MountainRatioMap[i] = MountainRatio;
+        }
+    });
+}
+
+void FOCGMapGenerator::ExportMap(const UMapPreset* MapPreset, const TArray<uint16>& InMap, const FString& FileName) const
+{
+    if (MapPreset->bExportMapTextures)
+    {
+        OCGMapDataUtils::ExportMap(InMap, MapPreset->MapResolution, FileName);
+    }
+}
+
+void FOCGMapGenerator::ExportMap(const UMapPreset* MapPreset, const TArray<FColor>& InMap,
+    const FString& FileName) const
+{
+    if (MapPreset->bExportMapTextures)
+    {
+        OCGMapDataUtils::ExportMap(InMap, MapPreset->MapResolution, FileName);
+    }
+}
+
+void FOCGMapGenerator::ExportWeightLayers(const UMapPreset* MapPreset, const FOCGWeightLayerBuffer& InWeightLayers) const
+{
+    if (!MapPreset->bExportMapTextures)
+        return;
+
+    for (int LayerIndex = 0; LayerIndex < InWeightLayers.Num(); ++LayerIndex)
+    {
+        FString FileName = FOCGWeightLayerBuffer::GetDefaultLayerName(LayerIndex).ToString() + ".png";
+        OCGMapDataUtils::ExportMap(InWeightLayers.GetLayer(LayerIndex), MapPreset->MapResolution, FileName);
+    }
+}
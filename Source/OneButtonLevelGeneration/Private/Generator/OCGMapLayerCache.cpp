@@ -0,0 +1,291 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Generator/OCGMapLayerCache.h"
+
+#include "OCGLog.h"
+#include "Async/ParallelFor.h"
+#include "Generator/OCGMapGenerator.h"
+#include "Hash/xxhash.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Compression.h"
+#include "Misc/Paths.h"
+#include "Serialization/LargeMemoryReader.h"
+#include "Serialization/LargeMemoryWriter.h"
+
+#include <atomic>
+
+namespace
+{
+	constexpr uint32 CacheFileMagic = 0x4D47434F; // "OCGM"
+	// Bump whenever the payload layout or the meaning of a stored map changes
+	constexpr int32 CacheFormatVersion = 3;
+	const TCHAR* CacheFileExtension = TEXT(".ocgmap");
+	// The payload is compressed in independent chunks, so chunks compress in parallel and stay below the int32 limit of FCompression
+	constexpr int64 ChunkSize = 16 * 1024 * 1024;
+	const FName CompressionFormat = NAME_Oodle;
+	// Upper bound of one serialized FOCGRegion, a map has at most one region per pixel
+	constexpr int64 MaxRegionBytes = 32;
+	// Array counts and the scalars of the result
+	constexpr int64 PayloadHeaderBytes = 4096;
+
+	struct FChunkHeader
+	{
+		int32 UncompressedSize = 0;
+		int32 CompressedSize = 0;
+	};
+
+	// Largest payload a valid entry of this size can have
+	int64 GetMaxPayloadSize(const FIntPoint& Resolution, const int32 NumWeightLayers)
+	{
+		const int64 NumPixels = static_cast<int64>(Resolution.X) * Resolution.Y;
+		// Height, temperature and humidity, weights, biome colour and index, region label and region
+		const int64 BytesPerPixel = 3 * sizeof(uint16) + NumWeightLayers + sizeof(FColor) + sizeof(uint8) + sizeof(int32) + MaxRegionBytes;
+		return NumPixels * BytesPerPixel + PayloadHeaderBytes;
+	}
+
+	FString GetEntryPath(const uint64 Key)
+	{
+		return OCGMapLayerCache::GetCacheDir() / FString::Printf(TEXT("%016llx%s"), Key, CacheFileExtension);
+	}
+
+	void SerializePayload(FArchive& Ar, FOCGMapGenerationResult& Result)
+	{
+		Ar << Result.Resolution;
+		Ar << Result.HeightMap;
+		Ar << Result.TemperatureMap;
+		Ar << Result.HumidityMap;
+		Result.WeightLayers.Serialize(Ar);
+		Ar << Result.BiomeColorMap;
+		Ar << Result.BiomeIndexMap;
+		Result.BiomeRegions.Serialize(Ar);
+		Ar << Result.CurMinHeight;
+		Ar << Result.CurMaxHeight;
+		Ar << Result.LandscapeZScale;
+		Ar << Result.ZOffset;
+	}
+}
+
+uint64 OCGMapLayerCache::GetVersionHash()
+{
+	check(IsInGameThread());
+
+	const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("OneButtonLevelGeneration"));
+	const FString PluginVersion = Plugin.IsValid() ? Plugin->GetDescriptor().VersionName : TEXT("Unknown");
+
+	FXxHash64Builder Builder;
+	Builder.Update(&CacheFormatVersion, sizeof(CacheFormatVersion));
+	Builder.Update(*PluginVersion, PluginVersion.Len() * sizeof(TCHAR));
+	return Builder.Finalize().Hash;
+}
+
+uint64 OCGMapLayerCache::MakeKey(const uint64 MapsStageKey, const uint64 VersionHash)
+{
+	const uint64 Keys[] = { MapsStageKey, VersionHash };
+	return FXxHash64::HashBuffer(Keys, sizeof(Keys)).Hash;
+}
+
+bool OCGMapLayerCache::Load(const uint64 Key, const FIntPoint& Resolution, const int32 NumWeightLayers, FOCGMapGenerationResult& OutResult)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(OCGMapLayerCache::Load);
+
+	const FString Path = GetEntryPath(Key);
+	const TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path, FILEREAD_Silent));
+	if (!Reader)
+		return false;
+
+	uint32 Magic = 0;
+	int32 FormatVersion = 0;
+	uint64 StoredKey = 0;
+	int64 PayloadSize = 0;
+	int32 NumChunks = 0;
+	*Reader << Magic << FormatVersion << StoredKey << PayloadSize << NumChunks;
+	if (Reader->IsError() || Magic != CacheFileMagic || FormatVersion != CacheFormatVersion || StoredKey != Key
+		|| PayloadSize <= 0 || PayloadSize > GetMaxPayloadSize(Resolution, NumWeightLayers)
+		|| NumChunks != FMath::DivideAndRoundUp(PayloadSize, ChunkSize))
+	{
+		UE_LOG(LogOCGModule, Warning, TEXT("Ignoring invalid map cache entry %s"), *Path);
+		return false;
+	}
+
+	TArray<FChunkHeader> Chunks;
+	Chunks.SetNum(NumChunks);
+	TArray<TArray<uint8>> CompressedChunks;
+	CompressedChunks.SetNum(NumChunks);
+	for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ++ChunkIndex)
+	{
+		FChunkHeader& Chunk = Chunks[ChunkIndex];
+		*Reader << Chunk.UncompressedSize << Chunk.CompressedSize;
+		if (Reader->IsError() || Chunk.CompressedSize <= 0 || Chunk.CompressedSize > Reader->TotalSize() - Reader->Tell()
+			|| Chunk.UncompressedSize <= 0 || Chunk.UncompressedSize > ChunkSize)
+		{
+			UE_LOG(LogOCGModule, Warning, TEXT("Ignoring invalid map cache entry %s"), *Path);
+			return false;
+		}
+
+		CompressedChunks[ChunkIndex].SetNumUninitialized(Chunk.CompressedSize);
+		Reader->Serialize(CompressedChunks[ChunkIndex].GetData(), Chunk.CompressedSize);
+	}
+	if (Reader->IsError())
+		return false;
+
+	TArray64<uint8> Payload;
+	Payload.SetNumUninitialized(PayloadSize);
+	std::atomic<bool> bDecompressed { true };
+	ParallelFor(NumChunks, [&](const int32 ChunkIndex)
+	{
+		const int64 Offset = ChunkIndex * ChunkSize;
+		const FChunkHeader& Chunk = Chunks[ChunkIndex];
+		if (Offset + Chunk.UncompressedSize > PayloadSize
+			|| !FCompression::UncompressMemory(CompressionFormat, Payload.GetData() + Offset, Chunk.UncompressedSize,
+				CompressedChunks[ChunkIndex].GetData(), Chunk.CompressedSize))
+		{
+			bDecompressed = false;
+		}
+	});
+	if (!bDecompressed)
+	{
+		UE_LOG(LogOCGModule, Warning, TEXT("Could not decompress map cache entry %s"), *Path);
+		return false;
+	}
+
+	FOCGMapGenerationResult Result;
+	FLargeMemoryReader PayloadReader(Payload.GetData(), Payload.Num());
+	SerializePayload(PayloadReader, Result);
+	const int64 NumPixels = static_cast<int64>(Resolution.X) * Resolution.Y;
+	if (PayloadReader.IsError() || Result.Resolution != Resolution || Result.HeightMap.Num() != NumPixels
+		|| Result.TemperatureMap.Num() != NumPixels || Result.HumidityMap.Num() != NumPixels)
+	{
+		UE_LOG(LogOCGModule, Warning, TEXT("Ignoring invalid map cache entry %s"), *Path);
+		return false;
+	}
+
+	// Entries are trimmed by modification time, a hit makes the entry the most recently used one
+	IFileManager::Get().SetTimeStamp(*Path, FDateTime::UtcNow());
+
+	OutResult = MoveTemp(Result);
+	return true;
+}
+
+void OCGMapLayerCache::Save(const uint64 Key, const FOCGMapGenerationResult& Result)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(OCGMapLayerCache::Save);
+
+	// Saving only reads the result, the archive interface just does not take const objects
+	FLargeMemoryWriter PayloadWriter;
+	SerializePayload(PayloadWriter, const_cast<FOCGMapGenerationResult&>(Result));
+	const int64 PayloadSize = PayloadWriter.TotalSize();
+	const uint8* PayloadData = PayloadWriter.GetData();
+
+	const int32 NumChunks = static_cast<int32>(FMath::DivideAndRoundUp(PayloadSize, ChunkSize));
+	TArray<FChunkHeader> Chunks;
+	Chunks.SetNum(NumChunks);
+	TArray<TArray<uint8>> CompressedChunks;
+	CompressedChunks.SetNum(NumChunks);
+	std::atomic<bool> bCompressed { true };
+	ParallelFor(NumChunks, [&](const int32 ChunkIndex)
+	{
+		const int64 Offset = ChunkIndex * ChunkSize;
+		FChunkHeader& Chunk = Chunks[ChunkIndex];
+		Chunk.UncompressedSize = static_cast<int32>(FMath::Min(ChunkSize, PayloadSize - Offset));
+
+		TArray<uint8>& CompressedChunk = CompressedChunks[ChunkIndex];
+		int32 CompressedSize = FCompression::CompressMemoryBound(CompressionFormat, Chunk.UncompressedSize);
+		CompressedChunk.SetNumUninitialized(CompressedSize);
+		if (!FCompression::CompressMemory(CompressionFormat, CompressedChunk.GetData(), CompressedSize, PayloadData + Offset, Chunk.UncompressedSize))
+		{
+			bCompressed = false;
+			return;
+		}
+		CompressedChunk.SetNum(CompressedSize, EAllowShrinking::No);
+		Chunk.CompressedSize = CompressedSize;
+	});
+	if (!bCompressed)
+	{
+		UE_LOG(LogOCGModule, Warning, TEXT("Could not compress the maps for the map cache"));
+		return;
+	}
+
+	// Written next to the entry and moved in place, so a reader never sees a partly written entry
+	const FString Path = GetEntryPath(Key);
+	const FString TempPath = FPaths::SetExtension(Path, FGuid::NewGuid().ToString() + TEXT(".tmp"));
+	{
+		const TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempPath));
+		if (!Writer)
+		{
+			UE_LOG(LogOCGModule, Warning, TEXT("Could not write map cache entry %s"), *TempPath);
+			return;
+		}
+
+		uint32 Magic = CacheFileMagic;
+		int32 FormatVersion = CacheFormatVersion;
+		uint64 StoredKey = Key;
+		int64 StoredPayloadSize = PayloadSize;
+		int32 StoredNumChunks = NumChunks;
+		*Writer << Magic << FormatVersion << StoredKey << StoredPayloadSize << StoredNumChunks;
+		for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ++ChunkIndex)
+		{
+			*Writer << Chunks[ChunkIndex].UncompressedSize << Chunks[ChunkIndex].CompressedSize;
+			Writer->Serialize(CompressedChunks[ChunkIndex].GetData(), CompressedChunks[ChunkIndex].Num());
+		}
+		if (!Writer->Close())
+		{
+			IFileManager::Get().Delete(*TempPath, false, false, true);
+			return;
+		}
+	}
+
+	if (!IFileManager::Get().Move(*Path, *TempPath, true, true, false, true))
+	{
+		IFileManager::Get().Delete(*TempPath, false, false, true);
+		return;
+	}
+
+	int64 CompressedBytes = 0;
+	for (const FChunkHeader& Chunk : Chunks)
+	{
+		CompressedBytes += Chunk.CompressedSize;
+	}
+	UE_LOG(LogOCGModule, Log, TEXT("Stored maps in the map cache, %.1f MB compressed to %.1f MB"),
+		PayloadSize / (1024.0 * 1024.0), CompressedBytes / (1024.0 * 1024.0));
+}
+
+void OCGMapLayerCache::Trim(const int64 MaxBytes)
+{
+	struct FEntry
+	{
+		FString Path;
+		int64 Size;
+		FDateTime ModificationTime;
+	};
+
+	TArray<FEntry> Entries;
+	int64 TotalBytes = 0;
+	IFileManager::Get().IterateDirectoryStat(*GetCacheDir(), [&Entries, &TotalBytes](const TCHAR* Path, const FFileStatData& StatData)
+	{
+		if (!StatData.bIsDirectory && FStringView(Path).EndsWith(CacheFileExtension))
+		{
+			Entries.Add({ Path, StatData.FileSize, StatData.ModificationTime });
+			TotalBytes += StatData.FileSize;
+		}
+		return true;
+	});
+	if (TotalBytes <= MaxBytes)
+		return;
+
+	Entries.Sort([](const FEntry& A, const FEntry& B) { return A.ModificationTime < B.ModificationTime; });
+	for (const FEntry& Entry : Entries)
+	{
+		if (TotalBytes <= MaxBytes)
+			break;
+		if (IFileManager::Get().Delete(*Entry.Path, false, false, true))
+		{
+			TotalBytes -= Entry.Size;
+		}
+	}
+}
+
+FString OCGMapLayerCache::GetCacheDir()
+{
+	return FPaths::ProjectSavedDir() / TEXT("OCG") / TEXT("MapCache");
+}
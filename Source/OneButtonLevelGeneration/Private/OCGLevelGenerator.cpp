@@ -17,6 +17,9 @@
 #include "Component/OCGTerrainGenerateComponent.h"
 #include "Data/MapData.h"
 #include "Data/MapPreset.h"
+#include "OCGDeveloperSettings.h"
+#include "Generator/OCGAsyncMapGeneration.h"
+#include "Utils/OCGGenerationStats.h"
 #include "Utils/OCGLandscapeUtil.h"
 
 AOCGLevelGenerator::AOCGLevelGenerator()
@@ -30,6 +33,11 @@ AOCGLevelGenerator::AOCGLevelGenerator()
 
 void AOCGLevelGenerator::Generate()
 {
+	if (!CheckMemoryBudget())
+		return;
+
+	FOCGScopedGenerationRun GenerationRun(TEXT("Level generation"));
+
 	if (MapGenerateComponent)
 	{
 		MapGenerateComponent->GenerateMaps();
@@ -50,14 +58,87 @@ void AOCGLevelGenerator::Generate()
 }
 
 void AOCGLevelGenerator::OnClickGenerate(UWorld* InWorld)
+{
+	if (!CanGenerateMaps())
+		return;
+
+	FOCGScopedGenerationRun GenerationRun(TEXT("Level generation"));
+	FlushPersistentDebugLines(GetWorld());
+	bool bHasHeightMap = false;
+	if (!ImportHeightMap(bHasHeightMap))
+		return;
+
+	const FOCGStageKeys Keys = ComputeStageKeys();
+	if (MapGenerateComponent && !AreMapsUpToDate(Keys))
+	{
+		if (!bHasHeightMap)
+			MapGenerateComponent->GenerateMaps();
+		else
+			MapGenerateComponent->GenerateMapsWithHeightMap();
+		MarkMapsGenerated(Keys);
+	}
+
+	GenerateLevelFromMaps(InWorld, Keys);
+}
+
+void AOCGLevelGenerator::GenerateAsync(UWorld* InWorld)
+{
+	if (!CanGenerateMaps())
+		return;
+
+	FlushPersistentDebugLines(GetWorld());
+	bool bHasHeightMap = false;
+	if (!ImportHeightMap(bHasHeightMap))
+		return;
+
+	TWeakObjectPtr<UWorld> WeakWorld(InWorld);
+	LaunchMapGeneration(bHasHeightMap, [this, WeakWorld](const FOCGStageKeys& Keys)
+	{
+		if (UWorld* World = WeakWorld.Get())
+		{
+			GenerateLevelFromMaps(World, Keys);
+		}
+	});
+}
+
+void AOCGLevelGenerator::CancelMapGeneration()
+{
+	if (MapGenerationJob.IsValid())
+	{
+		MapGenerationJob->Cancel();
+	}
+}
+
+bool AOCGLevelGenerator::IsGeneratingMaps() const
+{
+	return MapGenerationJob.IsValid() && MapGenerationJob->IsRunning();
+}
+
+float AOCGLevelGenerator::GetMapGenerationProgress() const
+{
+	return MapGenerationJob.IsValid() ? MapGenerationJob->GetProgress() : 0.f;
+}
+
+FText AOCGLevelGenerator::GetMapGenerationStageText() const
+{
+	return MapGenerationJob.IsValid() ? MapGenerationJob->GetStageText() : FText::GetEmpty();
+}
+
+bool AOCGLevelGenerator::CanGenerateMaps() const
 {
 	if (!MapPreset)
 	{
 		UE_LOG(LogOCGModule, Error, TEXT("MapPreset is not set! Please set a valid MapPreset before generating."));
-		return;
+		return false;
+	}
+
+	if (IsGeneratingMaps())
+	{
+		UE_LOG(LogOCGModule, Warning, TEXT("Maps are still being generated, cancel or wait for the running generation first."));
+		return false;
 	}
 	
-	if (!MapPreset || MapPreset->Biomes.IsEmpty())
+	if (MapPreset->Biomes.IsEmpty())
 	{
 		// Error message
 		const FText DialogTitle = FText::FromString(TEXT("Error"));
@@ -65,7 +146,7 @@ void AOCGLevelGenerator::OnClickGenerate(UWorld* InWorld)
 
 		FMessageDialog::Open(EAppMsgType::Ok, DialogText, DialogTitle);
 
-		return;
+		return false;
 	}
 	
 	for (const auto& Biome : MapPreset->Biomes)
@@ -76,47 +157,77 @@ void AOCGLevelGenerator::OnClickGenerate(UWorld* InWorld)
 			const FText DialogText = FText::FromString(TEXT("Invalid Biome Name. Please set a valid name for each biome."));
 
 			FMessageDialog::Open(EAppMsgType::Ok, DialogText, DialogTitle);
-			return;
+			return false;
 		}
 	}
 
-	FlushPersistentDebugLines(GetWorld());
-	bool bHasHeightMap = false;
-	if (!MapPreset->HeightmapFilePath.FilePath.IsEmpty())
+	return CheckMemoryBudget();
+}
+
+bool AOCGLevelGenerator::ImportHeightMap(bool& bOutHasHeightMap)
+{
+	bOutHasHeightMap = false;
+	ImportedHeightMapKey = 0;
+	if (MapPreset->HeightmapFilePath.FilePath.IsEmpty())
+		return true;
+
+	if (!OCGMapDataUtils::ImportMap(MapPreset->HeightMapData, MapPreset->MapResolution, MapPreset->HeightmapFilePath.FilePath))
 	{
-		if (!OCGMapDataUtils::ImportMap(MapPreset->HeightMapData, MapPreset->MapResolution, MapPreset->HeightmapFilePath.FilePath))
-		{
-			const FText DialogTitle = FText::FromString(TEXT("Error"));
-			const FText DialogText = FText::FromString(TEXT("Failed to read Height Map texture."));
+		const FText DialogTitle = FText::FromString(TEXT("Error"));
+		const FText DialogText = FText::FromString(TEXT("Failed to read Height Map texture."));
 
-			FMessageDialog::Open(EAppMsgType::Ok, DialogText, DialogTitle);
-			return;
-		}
-		bHasHeightMap = true;
+		FMessageDialog::Open(EAppMsgType::Ok, DialogText, DialogTitle);
+		return false;
 	}
-	
-	if (MapGenerateComponent)
+	++MapPreset->HeightMapRevision;
+	bOutHasHeightMap = true;
+	ImportedHeightMapKey = OCGStageGraph::HashHeightMap(MapPreset->HeightMapData);
+	return true;
+}
+
+void AOCGLevelGenerator::GenerateLevelFromMaps(UWorld* InWorld, const FOCGStageKeys& Keys)
+{
+	// A stage reruns when its key changed or when a stage it reads from reran in this pass
+	bool bStageRan[static_cast<int32>(EOCGGenerationStage::Num)] = {};
+	auto NeedsRun = [this, &Keys, &bStageRan](const EOCGGenerationStage Stage)
 	{
-		if (!bHasHeightMap)
-			MapGenerateComponent->GenerateMaps();
-		else
-			MapGenerateComponent->GenerateMapsWithHeightMap();
-	}
+		bool bNeedsRun = !IsStageUpToDate(Keys, Stage);
+		for (const EOCGGenerationStage UpstreamStage : OCGStageGraph::GetUpstreamStages(Stage))
+		{
+			bNeedsRun |= bStageRan[static_cast<int32>(UpstreamStage)];
+		}
+		if (!bNeedsRun)
+		{
+			UE_LOG(LogOCGModule, Log, TEXT("%s is up to date, skipped"), OCGStageGraph::GetStageName(Stage));
+		}
+		return bNeedsRun;
+	};
+	auto MarkRan = [this, &Keys, &bStageRan](const EOCGGenerationStage Stage)
+	{
+		bStageRan[static_cast<int32>(Stage)] = true;
+		LastStageKeys.Set(Stage, Keys.Get(Stage));
+	};
 
-	if (LandscapeGenerateComponent)
+	if (LandscapeGenerateComponent && (!GetLandscape() || NeedsRun(EOCGGenerationStage::Landscape)))
 	{
 		LandscapeGenerateComponent->SetLandscapeZValues(MapGenerateComponent->GetZScale(), MapGenerateComponent->GetZOffset());
 		LandscapeGenerateComponent->GenerateLandscape(InWorld);
+		MarkRan(EOCGGenerationStage::Landscape);
 	}
 
-	if (TerrainGenerateComponent)
+	if (TerrainGenerateComponent && NeedsRun(EOCGGenerationStage::Terrain))
 	{
 		TerrainGenerateComponent->GenerateTerrain(InWorld);
+		MarkRan(EOCGGenerationStage::Terrain);
 	}
 	
-	AddWaterPlane(InWorld);
+	if ((MapPreset && MapPreset->bContainWater && !SeaLevelWaterBody) || NeedsRun(EOCGGenerationStage::Water))
+	{
+		AddWaterPlane(InWorld);
+		MarkRan(EOCGGenerationStage::Water);
+	}
 
-	if (RiverGenerateComponent && MapGenerateComponent && LandscapeGenerateComponent && MapPreset)
+	if (RiverGenerateComponent && MapGenerateComponent && LandscapeGenerateComponent && MapPreset && NeedsRun(EOCGGenerationStage::River))
 	{
 		RiverGenerateComponent->SetMapData(
 			MapPreset->HeightMapData,
@@ -126,7 +237,81 @@ void AOCGLevelGenerator::OnClickGenerate(UWorld* InWorld)
 		);
 
 		RiverGenerateComponent->GenerateRiver(InWorld, LandscapeGenerateComponent->GetLandscape());
+		MarkRan(EOCGGenerationStage::River);
+	}
+}
+
+FOCGStageKeys AOCGLevelGenerator::ComputeStageKeys() const
+{
+	return OCGStageGraph::ComputeStageKeys(MapPreset, ImportedHeightMapKey);
+}
+
+bool AOCGLevelGenerator::IsStageUpToDate(const FOCGStageKeys& Keys, const EOCGGenerationStage Stage) const
+{
+	const UOCGDeveloperSettings* Settings = GetDefault<UOCGDeveloperSettings>();
+	if (!Settings || !Settings->bIncrementalGeneration)
+		return false;
+	return Keys.Matches(LastStageKeys, Stage);
+}
+
+bool AOCGLevelGenerator::AreMapsUpToDate(const FOCGStageKeys& Keys) const
+{
+	if (!IsStageUpToDate(Keys, EOCGGenerationStage::Maps))
+		return false;
+	// The preset may have been generated by another level generator since, or the map textures were not written yet
+	const int64 NumPixels = static_cast<int64>(MapPreset->MapResolution.X) * MapPreset->MapResolution.Y;
+	if (MapPreset->HeightMapData.Num() != NumPixels || (MapPreset->bExportMapTextures && !bLastMapsExported))
+		return false;
+
+	UE_LOG(LogOCGModule, Log, TEXT("Maps are up to date, skipped map generation"));
+	return true;
+}
+
+void AOCGLevelGenerator::MarkMapsGenerated(const FOCGStageKeys& Keys)
+{
+	LastStageKeys.Set(EOCGGenerationStage::Maps, Keys.Get(EOCGGenerationStage::Maps));
+	bLastMapsExported = MapPreset->bExportMapTextures;
+}
+
+void AOCGLevelGenerator::LaunchMapGeneration(const bool bHasHeightMap, TFunction<void(const FOCGStageKeys&)>&& OnMapsReady)
+{
+	const FOCGStageKeys Keys = ComputeStageKeys();
+	if (AreMapsUpToDate(Keys))
+	{
+		FOCGScopedGenerationRun GenerationRun(TEXT("Level generation"));
+		OnMapsReady(Keys);
+		return;
 	}
+
+	// The imported height map is copied here, the background task never touches the preset
+	TArray<uint16> HeightMap;
+	if (bHasHeightMap)
+	{
+		HeightMap = MapPreset->HeightMapData;
+	}
+
+	TWeakObjectPtr<AOCGLevelGenerator> WeakThis(this);
+	TWeakObjectPtr<UMapPreset> WeakPreset(MapPreset);
+	const bool bExportMapTextures = MapPreset->bExportMapTextures;
+	MapGenerationJob = FOCGAsyncMapGeneration::Launch(MapPreset, MoveTemp(HeightMap), MapGenerateComponent ? MapGenerateComponent->GetStageCache() : nullptr,
+		[WeakThis, WeakPreset, Keys, bExportMapTextures, OnMapsReady = MoveTemp(OnMapsReady)](const bool bCompleted, FOCGMapGenerationResult& Result)
+		{
+			AOCGLevelGenerator* LevelGenerator = WeakThis.Get();
+			if (!LevelGenerator)
+				return;
+			LevelGenerator->MapGenerationJob.Reset();
+
+			// Drop the result when the preset was swapped while the maps were generated
+			UMapPreset* Preset = WeakPreset.Get();
+			if (!bCompleted || !Preset || LevelGenerator->MapPreset != Preset || !LevelGenerator->MapGenerateComponent)
+				return;
+
+			FOCGScopedGenerationRun GenerationRun(TEXT("Level generation"));
+			LevelGenerator->MapGenerateComponent->ApplyResult(Preset, MoveTemp(Result));
+			LevelGenerator->LastStageKeys.Set(EOCGGenerationStage::Maps, Keys.Get(EOCGGenerationStage::Maps));
+			LevelGenerator->bLastMapsExported = bExportMapTextures;
+			OnMapsReady(Keys);
+		});
 }
 
 const TArray<uint16>& AOCGLevelGenerator::GetHeightMapData() const
@@ -144,7 +329,7 @@ const TArray<uint16>& AOCGLevelGenerator::GetHumidityMapData() const
 	return MapPreset->HumidityMapData;
 }
 
-const TMap<FName, TArray<uint8>>& AOCGLevelGenerator::GetWeightLayers() const
+const FOCGWeightLayerBuffer& AOCGLevelGenerator::GetWeightLayers() const
 {
 	return MapGenerateComponent->GetWeightLayers();
 }
@@ -335,53 +520,70 @@ void AOCGLevelGenerator::DrawDebugLandscape(TArray<uint16>& HeightMapData)
 
 void AOCGLevelGenerator::PreviewMaps()
 {
-	if (!MapPreset)
+	if (!CanGenerateMaps())
 		return;
-	if (MapPreset->Biomes.IsEmpty())
-	{
-		// Error message
-		const FText DialogTitle = FText::FromString(TEXT("Error"));
-		const FText DialogText = FText::FromString(TEXT("At Least one biome must be defined in the preset before generating the level."));
-
-		FMessageDialog::Open(EAppMsgType::Ok, DialogText, DialogTitle);
 
+	bool bHasHeightMap = false;
+	if (!ImportHeightMap(bHasHeightMap))
 		return;
-	}
-	
-	for (const auto& Biome : MapPreset->Biomes)
-	{
-		if (Biome.BiomeName == NAME_None)
-		{
-			const FText DialogTitle = FText::FromString(TEXT("Error"));
-			const FText DialogText = FText::FromString(TEXT("Invalid Biome Name. Please set a valid name for each biome."));
 
-			FMessageDialog::Open(EAppMsgType::Ok, DialogText, DialogTitle);
-			return;
-		}
-	}
 	bool bOriginalExportSetting = MapPreset->bExportMapTextures;
 	if (!bOriginalExportSetting)
 		MapPreset->bExportMapTextures = true;
 
-	if (MapPreset->HeightmapFilePath.FilePath.IsEmpty())
-		GetMapGenerateComponent()->GenerateMaps();
-	else
+	const FOCGStageKeys Keys = ComputeStageKeys();
+	if (!AreMapsUpToDate(Keys))
 	{
-		if (!OCGMapDataUtils::ImportMap(MapPreset->HeightMapData, MapPreset->MapResolution, MapPreset->HeightmapFilePath.FilePath))
-		{
-			const FText DialogTitle = FText::FromString(TEXT("Error"));
-			const FText DialogText = FText::FromString(TEXT("Failed to read Height Map texture."));
-
-			FMessageDialog::Open(EAppMsgType::Ok, DialogText, DialogTitle);
-			return;
-		}
-		GetMapGenerateComponent()->GenerateMapsWithHeightMap();
+		if (!bHasHeightMap)
+			GetMapGenerateComponent()->GenerateMaps();
+		else
+			GetMapGenerateComponent()->GenerateMapsWithHeightMap();
+		MarkMapsGenerated(Keys);
 	}
 	DrawDebugLandscape(MapPreset->HeightMapData);
 	
 	MapPreset->bExportMapTextures = bOriginalExportSetting;
 }
 
+void AOCGLevelGenerator::PreviewMapsAsync()
+{
+	if (!CanGenerateMaps())
+		return;
+
+	bool bHasHeightMap = false;
+	if (!ImportHeightMap(bHasHeightMap))
+		return;
+
+	// The generator copies the preset when it is launched, the export setting only has to be set for the launch
+	const bool bOriginalExportSetting = MapPreset->bExportMapTextures;
+	MapPreset->bExportMapTextures = true;
+	LaunchMapGeneration(bHasHeightMap, [this](const FOCGStageKeys&)
+	{
+		DrawDebugLandscape(MapPreset->HeightMapData);
+	});
+	MapPreset->bExportMapTextures = bOriginalExportSetting;
+}
+
+void AOCGLevelGenerator::BeginDestroy()
+{
+	CancelMapGeneration();
+	Super::BeginDestroy();
+}
+
+bool AOCGLevelGenerator::CheckMemoryBudget() const
+{
+	if (!MapPreset)
+		return true;
+
+	FText DialogText;
+	if (UOCGMapGenerateComponent::CheckMemoryBudget(MapPreset, DialogText))
+		return true;
+
+	const FText DialogTitle = FText::FromString(TEXT("Error"));
+	FMessageDialog::Open(EAppMsgType::Ok, DialogText, DialogTitle);
+	return false;
+}
+
 void AOCGLevelGenerator::RegenerateOcean()
 {
 	AddWaterPlane(GetWorld());
@@ -0,0 +1,120 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Utils/OCGDistanceTransform.h"
+
+#include "Utils/OCGParallelUtils.h"
+
+namespace
+{
+	// Vertical distance of a column without any seed
+	constexpr int32 NoSeed = TNumericLimits<int32>::Max();
+}
+
+void OCGDistanceTransform::EuclideanDistance(const TArray<bool>& InSeeds, const int32 Width, const int32 Height, const int32 MaxThreads,
+	TArray<float>& OutDistances)
+{
+	const int32 NumPixels = Width * Height;
+	OutDistances.SetNumUninitialized(NumPixels);
+	if (NumPixels <= 0 || InSeeds.Num() != NumPixels)
+		return;
+
+	// 1. Distance to the nearest seed in the same column. Each band sweeps a range of columns row by row,
+	// so memory is still read along rows
+	TArray<int32> VerticalDistance;
+	VerticalDistance.SetNumUninitialized(NumPixels);
+	FOCGParallelUtils::ParallelForRows(Width, MaxThreads, [&](const int32 StartX, const int32 EndX)
+	{
+		// Top to bottom
+		for (int32 x = StartX; x < EndX; ++x)
+		{
+			VerticalDistance[x] = InSeeds[x] ? 0 : NoSeed;
+		}
+		for (int32 y = 1; y < Height; ++y)
+		{
+			const int32 RowStart = y * Width;
+			for (int32 x = StartX; x < EndX; ++x)
+			{
+				const int32 Above = VerticalDistance[RowStart - Width + x];
+				VerticalDistance[RowStart + x] = InSeeds[RowStart + x] ? 0 : (Above == NoSeed ? NoSeed : Above + 1);
+			}
+		}
+
+		// Bottom to top
+		for (int32 y = Height - 2; y >= 0; --y)
+		{
+			const int32 RowStart = y * Width;
+			for (int32 x = StartX; x < EndX; ++x)
+			{
+				const int32 Below = VerticalDistance[RowStart + Width + x];
+				if (Below != NoSeed && Below + 1 < VerticalDistance[RowStart + x])
+				{
+					VerticalDistance[RowStart + x] = Below + 1;
+				}
+			}
+		}
+	});
+
+	// 2. Lower envelope of the parabolas (x - q)^2 + VerticalDistance(q)^2 along every row.
+	// Squared distances of large maps do not fit a float mantissa, so the envelope is built in double
+	FOCGParallelUtils::ParallelForRows(Height, MaxThreads, [&](const int32 StartY, const int32 EndY)
+	{
+		TArray<double> RowCost;
+		RowCost.SetNumUninitialized(Width);
+		TArray<int32> Vertices;
+		Vertices.SetNumUninitialized(Width);
+		TArray<double> Boundaries;
+		Boundaries.SetNumUninitialized(Width + 1);
+
+		for (int32 y = StartY; y < EndY; ++y)
+		{
+			const int32 RowStart = y * Width;
+			int32 k = -1;
+			for (int32 q = 0; q < Width; ++q)
+			{
+				const int32 Distance = VerticalDistance[RowStart + q];
+				if (Distance == NoSeed)
+					continue;
+
+				RowCost[q] = static_cast<double>(Distance) * Distance;
+				const double CostQ = RowCost[q] + static_cast<double>(q) * q;
+				double Intersection = 0.0;
+				while (k >= 0)
+				{
+					const int32 V = Vertices[k];
+					Intersection = (CostQ - (RowCost[V] + static_cast<double>(V) * V)) / (2.0 * (q - V));
+					if (Intersection > Boundaries[k])
+						break;
+					--k;
+				}
+
+				++k;
+				Vertices[k] = q;
+				Boundaries[k] = k == 0 ? TNumericLimits<double>::Lowest() : Intersection;
+				Boundaries[k + 1] = TNumericLimits<double>::Max();
+			}
+
+			float* OutRow = &OutDistances[RowStart];
+			if (k < 0)
+			{
+				// No seed in any column reaching this row, which means no seed at all
+				for (int32 x = 0; x < Width; ++x)
+				{
+					OutRow[x] = TNumericLimits<float>::Max();
+				}
+				continue;
+			}
+
+			k = 0;
+			for (int32 x = 0; x < Width; ++x)
+			{
+				while (Boundaries[k + 1] < x)
+				{
+					++k;
+				}
+				const int32 V = Vertices[k];
+				const double Offset = x - V;
+				OutRow[x] = static_cast<float>(FMath::Sqrt(Offset * Offset + RowCost[V]));
+			}
+		}
+	});
+}
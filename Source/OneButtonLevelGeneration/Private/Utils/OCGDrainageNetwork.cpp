@@ -0,0 +1,227 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Utils/OCGDrainageNetwork.h"
+
+namespace
+{
+	struct FFloodNode
+	{
+		// Height the water of the pixel has to reach before it spills
+		float Level;
+		int32 Index;
+	};
+
+	struct FChannelCandidate
+	{
+		int32 Accumulation;
+		// Lowest pixel of the channel and the pixel it flows into
+		int32 Mouth;
+		int32 Outlet;
+	};
+
+	template <typename FuncType>
+	FORCEINLINE void ForEachNeighbor(const int32 Index, const int32 Width, const int32 Height, FuncType&& Func)
+	{
+		const int32 X = Index % Width;
+		const int32 Y = Index / Width;
+		for (int32 DY = -1; DY <= 1; ++DY)
+		{
+			const int32 NY = Y + DY;
+			if (NY < 0 || NY >= Height)
+				continue;
+			for (int32 DX = -1; DX <= 1; ++DX)
+			{
+				const int32 NX = X + DX;
+				if ((DX == 0 && DY == 0) || NX < 0 || NX >= Width)
+					continue;
+				Func(NY * Width + NX);
+			}
+		}
+	}
+}
+
+void FOCGDrainageNetwork::Build(const TArray<float>& InHeights, const FIntPoint& InResolution, const float SeaHeight)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FOCGDrainageNetwork::Build);
+
+	Resolution = InResolution;
+	Receivers.Reset();
+	Accumulation.Reset();
+
+	const int32 Width = Resolution.X;
+	const int32 Height = Resolution.Y;
+	const int32 NumPixels = Width * Height;
+	if (NumPixels <= 0 || InHeights.Num() != NumPixels)
+		return;
+
+	// Pixels in the order they were reached, every pixel comes after the pixel it drains to
+	TArray<int32> Order;
+	Order.Reserve(NumPixels);
+	TBitArray<> Closed(false, NumPixels);
+	for (int32 Index = 0; Index < NumPixels; ++Index)
+	{
+		if (InHeights[Index] < SeaHeight)
+		{
+			Closed[Index] = true;
+			Order.Add(Index);
+		}
+	}
+	if (Order.IsEmpty())
+		return;
+
+	Receivers.Init(INDEX_NONE, NumPixels);
+	auto OpenPredicate = [](const FFloodNode& A, const FFloodNode& B) { return A.Level < B.Level; };
+	TArray<FFloodNode> Open;
+	// Pixels inside a depression drain at the spill level, they need no ordering among each other
+	TArray<FFloodNode> Pit;
+	int32 PitHead = 0;
+
+	// The coast drains into the sea
+	const int32 NumSeaPixels = Order.Num();
+	for (int32 OrderIndex = 0; OrderIndex < NumSeaPixels; ++OrderIndex)
+	{
+		const int32 SeaIndex = Order[OrderIndex];
+		ForEachNeighbor(SeaIndex, Width, Height, [&](const int32 Neighbor)
+		{
+			if (Closed[Neighbor])
+				return;
+			Closed[Neighbor] = true;
+			Receivers[Neighbor] = SeaIndex;
+			Order.Add(Neighbor);
+			Open.HeapPush({ InHeights[Neighbor], Neighbor }, OpenPredicate);
+		});
+	}
+
+	while (PitHead < Pit.Num() || Open.Num() > 0)
+	{
+		FFloodNode Current;
+		if (PitHead < Pit.Num())
+		{
+			Current = Pit[PitHead++];
+			if (PitHead == Pit.Num())
+			{
+				Pit.Reset();
+				PitHead = 0;
+			}
+		}
+		else
+		{
+			Open.HeapPop(Current, OpenPredicate, EAllowShrinking::No);
+		}
+
+		ForEachNeighbor(Current.Index, Width, Height, [&](const int32 Neighbor)
+		{
+			if (Closed[Neighbor])
+				return;
+			Closed[Neighbor] = true;
+			Receivers[Neighbor] = Current.Index;
+			Order.Add(Neighbor);
+			if (InHeights[Neighbor] <= Current.Level)
+			{
+				Pit.Add({ Current.Level, Neighbor });
+			}
+			else
+			{
+				Open.HeapPush({ InHeights[Neighbor], Neighbor }, OpenPredicate);
+			}
+		});
+	}
+
+	// Donors come after their receiver in the flood order, so one reverse sweep sums every upstream area
+	Accumulation.Init(0, NumPixels);
+	for (int32 OrderIndex = Order.Num() - 1; OrderIndex >= 0; --OrderIndex)
+	{
+		const int32 Index = Order[OrderIndex];
+		const int32 Receiver = Receivers[Index];
+		if (Receiver == INDEX_NONE)
+			continue;
+		Accumulation[Index] += 1;
+		Accumulation[Receiver] += Accumulation[Index];
+	}
+}
+
+void FOCGDrainageNetwork::ExtractChannels(const int32 NumChannels, const int32 MinAccumulation, const int32 MinLength,
+	TArray<TArray<FIntPoint>>& OutChannels) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FOCGDrainageNetwork::ExtractChannels);
+
+	OutChannels.Reset();
+	if (IsEmpty())
+		return;
+
+	const int32 Width = Resolution.X;
+	const int32 Height = Resolution.Y;
+
+	// Largest drained area first, ties by pixel index so the result does not depend on the heap layout
+	auto CandidatePredicate = [](const FChannelCandidate& A, const FChannelCandidate& B)
+	{
+		return A.Accumulation > B.Accumulation || (A.Accumulation == B.Accumulation && A.Mouth < B.Mouth);
+	};
+
+	TArray<FChannelCandidate> Candidates;
+	for (int32 Index = 0; Index < Receivers.Num(); ++Index)
+	{
+		const int32 Receiver = Receivers[Index];
+		if (Receiver != INDEX_NONE && Receivers[Receiver] == INDEX_NONE && Accumulation[Index] >= MinAccumulation)
+		{
+			Candidates.Add({ Accumulation[Index], Index, Receiver });
+		}
+	}
+	Candidates.Heapify(CandidatePredicate);
+
+	TArray<int32> Path;
+	// Tributaries of the channel being traced, they only become candidates once the channel is kept
+	TArray<FChannelCandidate> Tributaries;
+	FChannelCandidate Candidate;
+	while (OutChannels.Num() < NumChannels && Candidates.Num() > 0)
+	{
+		Candidates.HeapPop(Candidate, CandidatePredicate, EAllowShrinking::No);
+
+		Path.Reset();
+		Tributaries.Reset();
+		Path.Add(Candidate.Outlet);
+		Path.Add(Candidate.Mouth);
+		int32 Current = Candidate.Mouth;
+		while (true)
+		{
+			// Follow the largest donor, the other large donors become tributaries joining at this pixel
+			int32 MainDonor = INDEX_NONE;
+			ForEachNeighbor(Current, Width, Height, [&](const int32 Neighbor)
+			{
+				if (Receivers[Neighbor] != Current || Accumulation[Neighbor] < MinAccumulation)
+					return;
+				if (MainDonor == INDEX_NONE || Accumulation[Neighbor] > Accumulation[MainDonor])
+				{
+					if (MainDonor != INDEX_NONE)
+					{
+						Tributaries.Add({ Accumulation[MainDonor], MainDonor, Current });
+					}
+					MainDonor = Neighbor;
+				}
+				else
+				{
+					Tributaries.Add({ Accumulation[Neighbor], Neighbor, Current });
+				}
+			});
+			if (MainDonor == INDEX_NONE)
+				break;
+			Path.Add(MainDonor);
+			Current = MainDonor;
+		}
+
+		if (Path.Num() < MinLength)
+			continue;
+
+		for (const FChannelCandidate& Tributary : Tributaries)
+		{
+			Candidates.HeapPush(Tributary, CandidatePredicate);
+		}
+
+		TArray<FIntPoint>& Channel = OutChannels.AddDefaulted_GetRef();
+		Channel.Reserve(Path.Num());
+		for (int32 PathIndex = Path.Num() - 1; PathIndex >= 0; --PathIndex)
+		{
+			Channel.Add(FIntPoint(Path[PathIndex] % Width, Path[PathIndex] / Width));
+		}
+	}
+}
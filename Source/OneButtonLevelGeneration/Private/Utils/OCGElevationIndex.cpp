@@ -0,0 +1,84 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Utils/OCGElevationIndex.h"
+
+namespace
+{
+	constexpr int32 NumHeightValues = TNumericLimits<uint16>::Max() + 1;
+}
+
+void FOCGElevationIndex::Build(const TArray<uint16>& InHeightMap, const FIntPoint& InResolution)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FOCGElevationIndex::Build);
+
+	Reset();
+	const int32 NumPixels = InResolution.X * InResolution.Y;
+	if (NumPixels <= 0 || InHeightMap.Num() < NumPixels)
+		return;
+
+	Resolution = InResolution;
+	BucketStarts.Init(0, NumHeightValues + 1);
+	for (int32 Index = 0; Index < NumPixels; ++Index)
+	{
+		++BucketStarts[InHeightMap[Index] + 1];
+	}
+	for (int32 Value = 1; Value <= NumHeightValues; ++Value)
+	{
+		BucketStarts[Value] += BucketStarts[Value - 1];
+	}
+
+	// Filling in pixel order keeps every bucket sorted by pixel index, the index does not depend on anything but the map
+	TArray<int32> Cursors(BucketStarts.GetData(), NumHeightValues);
+	SortedPixels.SetNumUninitialized(NumPixels);
+	for (int32 Index = 0; Index < NumPixels; ++Index)
+	{
+		SortedPixels[Cursors[InHeightMap[Index]]++] = Index;
+	}
+}
+
+void FOCGElevationIndex::Reset()
+{
+	Resolution = FIntPoint::ZeroValue;
+	BucketStarts.Reset();
+	SortedPixels.Reset();
+}
+
+TConstArrayView<int32> FOCGElevationIndex::GetPixelsAtOrAbove(const uint16 MinHeight) const
+{
+	if (IsEmpty())
+		return TConstArrayView<int32>();
+
+	const int32 First = BucketStarts[MinHeight];
+	return TConstArrayView<int32>(SortedPixels.GetData() + First, SortedPixels.Num() - First);
+}
+
+bool FOCGElevationIndex::SampleAtOrAbove(const uint16 MinHeight, FRandomStream& Stream, const float MinSpacing,
+	const TConstArrayView<FIntPoint> Taken, const int32 MaxAttempts, FIntPoint& OutPoint) const
+{
+	const TConstArrayView<int32> Candidates = GetPixelsAtOrAbove(MinHeight);
+	if (Candidates.IsEmpty())
+		return false;
+
+	const float MinSpacingSquared = FMath::Square(MinSpacing);
+	float BestDistanceSquared = -1.f;
+	for (int32 Attempt = 0; Attempt < FMath::Max(MaxAttempts, 1); ++Attempt)
+	{
+		const int32 Index = Candidates[Stream.RandRange(0, Candidates.Num() - 1)];
+		const FIntPoint Candidate(Index % Resolution.X, Index / Resolution.X);
+
+		float DistanceSquared = TNumericLimits<float>::Max();
+		for (const FIntPoint& Point : Taken)
+		{
+			DistanceSquared = FMath::Min(DistanceSquared, static_cast<float>((Candidate - Point).SizeSquared()));
+		}
+
+		if (DistanceSquared > BestDistanceSquared)
+		{
+			BestDistanceSquared = DistanceSquared;
+			OutPoint = Candidate;
+		}
+		if (DistanceSquared >= MinSpacingSquared)
+			break;
+	}
+	return true;
+}
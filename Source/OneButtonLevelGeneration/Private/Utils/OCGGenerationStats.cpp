@@ -0,0 +1,143 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Utils/OCGGenerationStats.h"
+
+#include "OCGLog.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "Utils/OCGMemoryUtils.h"
+
+TRACE_DECLARE_INT_COUNTER(OCGStagePixels, TEXT("OCG/Stage Pixels"));
+TRACE_DECLARE_MEMORY_COUNTER(OCGScratchMemory, TEXT("OCG/Scratch Memory"));
+
+namespace
+{
+	constexpr double BytesPerMB = 1024.0 * 1024.0;
+
+	FString GetPluginVersion()
+	{
+		const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("OneButtonLevelGeneration"));
+		return Plugin.IsValid() ? Plugin->GetDescriptor().VersionName : TEXT("Unknown");
+	}
+
+	// Millions of pixels per second, 0 for stages that are not per pixel
+	double GetMegaPixelsPerSecond(const FOCGStageStats& Stage)
+	{
+		if (Stage.NumPixels <= 0 || Stage.Milliseconds <= 0.0)
+			return 0.0;
+		return Stage.NumPixels / (Stage.Milliseconds * 1000.0);
+	}
+}
+
+FOCGGenerationStats& FOCGGenerationStats::Get()
+{
+	static FOCGGenerationStats Instance;
+	return Instance;
+}
+
+void FOCGGenerationStats::BeginRun()
+{
+	if (RunDepth++ == 0)
+	{
+		Stages.Reset();
+		OpenStages.Reset();
+	}
+}
+
+void FOCGGenerationStats::EndRun(const TCHAR* RunName)
+{
+	if (RunDepth == 0 || --RunDepth > 0)
+		return;
+
+	LogSummary(RunName);
+	WriteCsv(RunName);
+}
+
+void FOCGGenerationStats::BeginStage(FOCGScratchBufferPool* Pool)
+{
+	if (Pool)
+	{
+		Pool->ResetPeak();
+	}
+
+	FOpenStage& Stage = OpenStages.AddDefaulted_GetRef();
+	Stage.StartUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+	Stage.StartTime = FPlatformTime::Seconds();
+}
+
+void FOCGGenerationStats::EndStage(const TCHAR* StageName, const int64 NumPixels, const FOCGScratchBufferPool* Pool)
+{
+	const double EndTime = FPlatformTime::Seconds();
+	if (OpenStages.IsEmpty())
+		return;
+	const FOpenStage OpenStage = OpenStages.Pop();
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+
+	FOCGStageStats& Stage = Stages.AddDefaulted_GetRef();
+	Stage.StageName = StageName;
+	Stage.Milliseconds = (EndTime - OpenStage.StartTime) * 1000.0;
+	Stage.NumPixels = NumPixels;
+	Stage.ScratchPeakBytes = Pool ? Pool->GetPeakBytes() : 0;
+	Stage.UsedPhysicalDelta = static_cast<int64>(MemoryStats.UsedPhysical) - static_cast<int64>(OpenStage.StartUsedPhysical);
+	Stage.PeakUsedPhysical = MemoryStats.PeakUsedPhysical;
+
+	TRACE_COUNTER_SET(OCGStagePixels, NumPixels);
+	TRACE_COUNTER_SET(OCGScratchMemory, Stage.ScratchPeakBytes);
+
+	UE_LOG(LogOCGModule, Log, TEXT("%s took %.2f ms"), StageName, Stage.Milliseconds);
+}
+
+void FOCGGenerationStats::AddStage(const FOCGStageStats& Stage)
+{
+	Stages.Add(Stage);
+}
+
+void FOCGGenerationStats::ResetStages()
+{
+	Stages.Reset();
+	OpenStages.Reset();
+}
+
+void FOCGGenerationStats::LogSummary(const TCHAR* RunName) const
+{
+	double TotalMilliseconds = 0.0;
+	UE_LOG(LogOCGModule, Log, TEXT("%s stages:"), RunName);
+	UE_LOG(LogOCGModule, Log, TEXT("  %-40s %10s %10s %12s %14s %14s"), TEXT("Stage"), TEXT("ms"), TEXT("MPix/s"), TEXT("Scratch MB"),
+		TEXT("Used delta MB"), TEXT("Peak used MB"));
+	for (const FOCGStageStats& Stage : Stages)
+	{
+		UE_LOG(LogOCGModule, Log, TEXT("  %-40s %10.2f %10.2f %12.1f %+14.1f %14.1f"), *Stage.StageName, Stage.Milliseconds,
+			GetMegaPixelsPerSecond(Stage), Stage.ScratchPeakBytes / BytesPerMB, Stage.UsedPhysicalDelta / BytesPerMB,
+			Stage.PeakUsedPhysical / BytesPerMB);
+		TotalMilliseconds += Stage.Milliseconds;
+	}
+	UE_LOG(LogOCGModule, Log, TEXT("  %-40s %10.2f"), TEXT("Total of stages"), TotalMilliseconds);
+}
+
+void FOCGGenerationStats::WriteCsv(const TCHAR* RunName) const
+{
+	if (Stages.IsEmpty())
+		return;
+
+	const FString PluginVersion = GetPluginVersion();
+	FString Csv = TEXT("Run,PluginVersion,Stage,Milliseconds,Pixels,MegaPixelsPerSecond,ScratchPeakMB,UsedPhysicalDeltaMB,PeakUsedPhysicalMB\n");
+	for (const FOCGStageStats& Stage : Stages)
+	{
+		Csv += FString::Printf(TEXT("\"%s\",%s,\"%s\",%.3f,%lld,%.3f,%.1f,%.1f,%.1f\n"), RunName, *PluginVersion, *Stage.StageName,
+			Stage.Milliseconds, Stage.NumPixels, GetMegaPixelsPerSecond(Stage), Stage.ScratchPeakBytes / BytesPerMB,
+			Stage.UsedPhysicalDelta / BytesPerMB, Stage.PeakUsedPhysical / BytesPerMB);
+	}
+
+	const FString FilePath = FPaths::ProjectSavedDir() / TEXT("OCG") / TEXT("Stats")
+		/ FString::Printf(TEXT("GenerationStats_%s.csv"), *FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S")));
+	if (FFileHelper::SaveStringToFile(Csv, *FilePath))
+	{
+		UE_LOG(LogOCGModule, Log, TEXT("Generation stats written to %s"), *FilePath);
+	}
+	else
+	{
+		UE_LOG(LogOCGModule, Warning, TEXT("Failed to write generation stats to %s"), *FilePath);
+	}
+}
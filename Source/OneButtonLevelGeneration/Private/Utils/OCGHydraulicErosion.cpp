@@ -0,0 +1,232 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Utils/OCGHydraulicErosion.h"
+
+#include "Utils/OCGParallelUtils.h"
+
+namespace
+{
+	constexpr float PipeGravity = 9.81f;
+	// Keeps a little carrying capacity on flat ground so water still moves sediment there
+	constexpr float MinTiltSine = 0.05f;
+	// Water depth under which a cell is treated as dry when computing velocity
+	constexpr float MinWaterDepth = 1.e-4f;
+
+	// Simulation state, one value per cell. Flux is the water flowing out of a cell to each neighbour
+	struct FPipeGrid
+	{
+		TArray<float> Terrain;
+		TArray<float> TerrainNext;
+		TArray<float> Water;
+		TArray<float> Sediment;
+		TArray<float> SedimentNext;
+		TArray<float> FluxLeft;
+		TArray<float> FluxRight;
+		TArray<float> FluxUp;
+		TArray<float> FluxDown;
+		TArray<float> VelocityX;
+		TArray<float> VelocityY;
+	};
+
+	FORCEINLINE float SampleBilinear(const TArray<float>& Values, const int32 Width, const int32 Height, float X, float Y)
+	{
+		X = FMath::Clamp(X, 0.f, static_cast<float>(Width - 1));
+		Y = FMath::Clamp(Y, 0.f, static_cast<float>(Height - 1));
+		const int32 X0 = FMath::Min(static_cast<int32>(X), Width - 2);
+		const int32 Y0 = FMath::Min(static_cast<int32>(Y), Height - 2);
+		const float FracX = X - X0;
+		const float FracY = Y - Y0;
+
+		const int32 Index = Y0 * Width + X0;
+		const float Top = FMath::Lerp(Values[Index], Values[Index + 1], FracX);
+		const float Bottom = FMath::Lerp(Values[Index + Width], Values[Index + Width + 1], FracX);
+		return FMath::Lerp(Top, Bottom, FracY);
+	}
+}
+
+void OCGHydraulicErosion::ErodePipeModel(const FOCGPipeErosionSettings& Settings, const int32 Width, const int32 Height, TArray<float>& InOutHeights)
+{
+	if (Width < 3 || Height < 3 || Settings.Iterations <= 0 || Settings.CellSize <= 0.f || InOutHeights.Num() != Width * Height)
+		return;
+
+	const int32 NumCells = Width * Height;
+	const int32 MaxThreads = Settings.MaxThreads;
+	const float Dt = Settings.TimeStep;
+
+	// Simulate in cell units (distance between two cells is 1) so pipe length and cross-section drop out of the equations
+	const float ToCellUnits = 1.f / Settings.CellSize;
+	const float SeaLevel = Settings.SeaLevelHeight * ToCellUnits;
+	const float Rain = Settings.RainAmount * ToCellUnits;
+	const float Evaporation = FMath::Clamp(1.f - Settings.EvaporationRate * Dt, 0.f, 1.f);
+
+	FPipeGrid Grid;
+	Grid.Terrain.SetNumUninitialized(NumCells);
+	Grid.TerrainNext.SetNumUninitialized(NumCells);
+	Grid.Water.Init(Rain, NumCells);
+	Grid.Sediment.Init(0.f, NumCells);
+	Grid.SedimentNext.SetNumUninitialized(NumCells);
+	Grid.FluxLeft.Init(0.f, NumCells);
+	Grid.FluxRight.Init(0.f, NumCells);
+	Grid.FluxUp.Init(0.f, NumCells);
+	Grid.FluxDown.Init(0.f, NumCells);
+	Grid.VelocityX.Init(0.f, NumCells);
+	Grid.VelocityY.Init(0.f, NumCells);
+
+	for (int32 i = 0; i < NumCells; ++i)
+	{
+		Grid.Terrain[i] = InOutHeights[i] * ToCellUnits;
+	}
+
+	for (int32 Iteration = 0; Iteration < Settings.Iterations; ++Iteration)
+	{
+		// 1. Outflow flux. Every cell only writes its own flux, neighbours are read from terrain and water
+		FOCGParallelUtils::ParallelForRows(Height, MaxThreads, [&](const int32 StartRow, const int32 EndRow)
+		{
+			for (int32 y = StartRow; y < EndRow; ++y)
+			{
+				for (int32 x = 0; x < Width; ++x)
+				{
+					const int32 Index = y * Width + x;
+					const float Surface = Grid.Terrain[Index] + Grid.Water[Index];
+					auto Outflow = [&](const float OldFlux, const int32 NeighbourIndex)
+					{
+						const float HeightDiff = Surface - Grid.Terrain[NeighbourIndex] - Grid.Water[NeighbourIndex];
+						return FMath::Max(0.f, OldFlux + Dt * PipeGravity * HeightDiff);
+					};
+
+					// Map border is closed
+					float Left = x > 0 ? Outflow(Grid.FluxLeft[Index], Index - 1) : 0.f;
+					float Right = x < Width - 1 ? Outflow(Grid.FluxRight[Index], Index + 1) : 0.f;
+					float Up = y > 0 ? Outflow(Grid.FluxUp[Index], Index - Width) : 0.f;
+					float Down = y < Height - 1 ? Outflow(Grid.FluxDown[Index], Index + Width) : 0.f;
+
+					// Never let more water leave than the cell holds
+					const float TotalOutflow = (Left + Right + Up + Down) * Dt;
+					if (TotalOutflow > Grid.Water[Index] && TotalOutflow > 0.f)
+					{
+						const float Scale = Grid.Water[Index] / TotalOutflow;
+						Left *= Scale;
+						Right *= Scale;
+						Up *= Scale;
+						Down *= Scale;
+					}
+
+					Grid.FluxLeft[Index] = Left;
+					Grid.FluxRight[Index] = Right;
+					Grid.FluxUp[Index] = Up;
+					Grid.FluxDown[Index] = Down;
+				}
+			}
+		});
+
+		// 2. Water height and velocity from the net flux
+		FOCGParallelUtils::ParallelForRows(Height, MaxThreads, [&](const int32 StartRow, const int32 EndRow)
+		{
+			for (int32 y = StartRow; y < EndRow; ++y)
+			{
+				for (int32 x = 0; x < Width; ++x)
+				{
+					const int32 Index = y * Width + x;
+					const float InFromLeft = x > 0 ? Grid.FluxRight[Index - 1] : 0.f;
+					const float InFromRight = x < Width - 1 ? Grid.FluxLeft[Index + 1] : 0.f;
+					const float InFromUp = y > 0 ? Grid.FluxDown[Index - Width] : 0.f;
+					const float InFromDown = y < Height - 1 ? Grid.FluxUp[Index + Width] : 0.f;
+
+					const float Inflow = InFromLeft + InFromRight + InFromUp + InFromDown;
+					const float Outflow = Grid.FluxLeft[Index] + Grid.FluxRight[Index] + Grid.FluxUp[Index] + Grid.FluxDown[Index];
+
+					const float OldWater = Grid.Water[Index];
+					const float NewWater = FMath::Max(0.f, OldWater + Dt * (Inflow - Outflow));
+					Grid.Water[Index] = NewWater;
+
+					const float AverageWater = (OldWater + NewWater) * 0.5f;
+					if (AverageWater > MinWaterDepth)
+					{
+						const float FlowX = (InFromLeft - Grid.FluxLeft[Index] + Grid.FluxRight[Index] - InFromRight) * 0.5f;
+						const float FlowY = (InFromUp - Grid.FluxUp[Index] + Grid.FluxDown[Index] - InFromDown) * 0.5f;
+						Grid.VelocityX[Index] = FlowX / AverageWater;
+						Grid.VelocityY[Index] = FlowY / AverageWater;
+					}
+					else
+					{
+						Grid.VelocityX[Index] = 0.f;
+						Grid.VelocityY[Index] = 0.f;
+					}
+				}
+			}
+		});
+
+		// 3. Erosion and deposition, written to TerrainNext because the tilt reads neighbouring terrain
+		FOCGParallelUtils::ParallelForRows(Height, MaxThreads, [&](const int32 StartRow, const int32 EndRow)
+		{
+			for (int32 y = StartRow; y < EndRow; ++y)
+			{
+				for (int32 x = 0; x < Width; ++x)
+				{
+					const int32 Index = y * Width + x;
+					const float Terrain = Grid.Terrain[Index];
+					if (Terrain <= SeaLevel)
+					{
+						Grid.TerrainNext[Index] = Terrain;
+						continue;
+					}
+
+					const float GradientX = (Grid.Terrain[FMath::Min(x + 1, Width - 1) + y * Width] - Grid.Terrain[FMath::Max(x - 1, 0) + y * Width]) * 0.5f;
+					const float GradientY = (Grid.Terrain[x + FMath::Min(y + 1, Height - 1) * Width] - Grid.Terrain[x + FMath::Max(y - 1, 0) * Width]) * 0.5f;
+					const float SlopeSquared = GradientX * GradientX + GradientY * GradientY;
+					const float TiltSine = FMath::Max(FMath::Sqrt(SlopeSquared / (1.f + SlopeSquared)), MinTiltSine);
+
+					const float Speed = FMath::Sqrt(Grid.VelocityX[Index] * Grid.VelocityX[Index] + Grid.VelocityY[Index] * Grid.VelocityY[Index]);
+					const float Capacity = Settings.SedimentCapacity * TiltSine * Speed;
+					const float Sediment = Grid.Sediment[Index];
+
+					if (Capacity > Sediment)
+					{
+						const float Amount = Settings.DissolveRate * (Capacity - Sediment);
+						Grid.TerrainNext[Index] = Terrain - Amount;
+						Grid.Sediment[Index] = Sediment + Amount;
+					}
+					else
+					{
+						const float Amount = Settings.DepositRate * (Sediment - Capacity);
+						Grid.TerrainNext[Index] = Terrain + Amount;
+						Grid.Sediment[Index] = Sediment - Amount;
+					}
+				}
+			}
+		});
+		Swap(Grid.Terrain, Grid.TerrainNext);
+
+		// 4. Carry sediment along the velocity field (semi-Lagrangian), then evaporate and rain for the next iteration.
+		// Cells under the sea drain everything they receive
+		const bool bLastIteration = Iteration == Settings.Iterations - 1;
+		FOCGParallelUtils::ParallelForRows(Height, MaxThreads, [&](const int32 StartRow, const int32 EndRow)
+		{
+			for (int32 y = StartRow; y < EndRow; ++y)
+			{
+				for (int32 x = 0; x < Width; ++x)
+				{
+					const int32 Index = y * Width + x;
+					if (Grid.Terrain[Index] <= SeaLevel)
+					{
+						Grid.SedimentNext[Index] = 0.f;
+						Grid.Water[Index] = 0.f;
+						continue;
+					}
+
+					const float SourceX = x - Grid.VelocityX[Index] * Dt;
+					const float SourceY = y - Grid.VelocityY[Index] * Dt;
+					Grid.SedimentNext[Index] = SampleBilinear(Grid.Sediment, Width, Height, SourceX, SourceY);
+					Grid.Water[Index] = Grid.Water[Index] * Evaporation + (bLastIteration ? 0.f : Rain);
+				}
+			}
+		});
+		Swap(Grid.Sediment, Grid.SedimentNext);
+	}
+
+	// Sediment still suspended when the rain stops settles where it is
+	for (int32 i = 0; i < NumCells; ++i)
+	{
+		InOutHeights[i] = (Grid.Terrain[i] + Grid.Sediment[i]) * Settings.CellSize;
+	}
+}
@@ -11,7 +11,10 @@
 #include "Component/OCGRiverGeneratorComponent.h"
 #include "Data/MapData.h"
 #include "Data/MapPreset.h"
+#include "Data/OCGWeightLayerBuffer.h"
 #include "PCG/OCGLandscapeVolume.h"
+#include "Utils/OCGBlur.h"
+#include "Utils/OCGGenerationStats.h"
 #include "Utils/OCGMaterialEditTool.h"
 #include "Utils/OCGUtils.h"
 
@@ -430,39 +433,10 @@ void OCGLandscapeUtil::MakeWeightMapFromHeightDiff(const TArray<uint16>& HeightD
 
 void OCGLandscapeUtil::BlurWeightMap(const TArray<uint8>& InWeight, TArray<uint8>& OutWeight, const int32 Width, const int32 Height)
 {
-	const int32 Num = Width * Height;
-	OutWeight.SetNumUninitialized(Num);
-	
-	TArray<float> TempAccum;
-	TempAccum.SetNumZeroed(Num);
-	
-	const uint8* InData   = InWeight.GetData();
-	float*       TempData = TempAccum.GetData();
-	
-	for (int32 y = 0; y < Height; ++y)
-	{
-		const int32 Base = y * Width;
-		for (int32 x = 0; x < Width; ++x)
-		{
-			float Sum = InData[Base + x];
-			if (x > 0)         Sum += InData[Base + x - 1];
-			if (x < Width - 1) Sum += InData[Base + x + 1];
-			TempData[Base + x] = Sum / 3.0f;
-		}
-	}
+	OutWeight.SetNumUninitialized(Width * Height);
 
-	for (int32 x = 0; x < Width; ++x)
-	{
-		for (int32 y = 0; y < Height; ++y)
-		{
-			const int32 Idx = y * Width + x;
-			float Sum = TempData[Idx];
-			if (y > 0)          Sum += TempData[Idx - Width];
-			if (y < Height - 1) Sum += TempData[Idx + Width];
-			const int32 Val = FMath::RoundToInt(Sum / 3.0f);
-			OutWeight[Idx] = static_cast<uint8>(FMath::Clamp(Val, 0, 255));
-		}
-	}
+	// 3 x 3 average, pixels outside of the map count as 0
+	OCGBlur::BoxBlur(InWeight.GetData(), OutWeight.GetData(), Width, Height, 1, EOCGBlurEdgeMode::Zero);
 }
 
 void OCGLandscapeUtil::ClearTargetLayers(const ALandscape* InLandscape)
@@ -658,6 +632,7 @@ void OCGLandscapeUtil::ManageLandscapeRegions(UWorld* World, const ALandscape* L
 	const FLandscapeSetting& InLandscapeSetting)
 {
 	#if WITH_EDITOR
+	OCG_SCOPED_GENERATION_STAGE(TEXT("Managing Landscape Regions"), 0);
     ULandscapeInfo* LandscapeInfo = Landscape->GetLandscapeInfo();
     ALandscapeProxy* LandscapeProxy = nullptr;
 	if (InMapPreset == nullptr)
@@ -758,6 +733,7 @@ void OCGLandscapeUtil::ImportMapDatas(UWorld* World, ALandscape* InLandscape, TA
                                       TArray<FLandscapeImportLayerInfo> ImportLayers)
 {
 	#if WITH_EDITOR
+	OCG_SCOPED_GENERATION_STAGE(TEXT("Importing Map Data"), ImportHeightMap.Num());
 	if (World == nullptr)
 		return;
 	
@@ -1256,7 +1232,7 @@ TMap<FGuid, TArray<FLandscapeImportLayerInfo>> OCGLandscapeUtil::PrepareLandscap
     ULandscapeLayerInfoObject* DefaultLayerInfo = Settings->GetDefaultLayerInfoObject().LoadSynchronous();
 
     // 1. Get the layer name from the weightmap data and the material.
-    TMap<FName, TArray<uint8>> WeightLayers = InLevelGenerator->GetWeightLayers();
+    const FOCGWeightLayerBuffer& WeightLayers = InLevelGenerator->GetWeightLayers();
     TArray<FName> LayerNames;
     if (InMapPreset->LandscapeMaterial && InMapPreset->LandscapeMaterial->Parent)
     {
@@ -1269,10 +1245,10 @@ TMap<FGuid, TArray<FLandscapeImportLayerInfo>> OCGLandscapeUtil::PrepareLandscap
         FLandscapeImportLayerInfo LayerInfo;
 
     	// Generate a temporary name (in case the name cannot be found in the material)
-        FString TempLayerNameStr = FString::Printf(TEXT("Layer%d"), Index);
-        FName TempLayerName(TempLayerNameStr);
+        FName TempLayerName = FOCGWeightLayerBuffer::GetDefaultLayerName(Index);
 
-        LayerInfo.LayerData = WeightLayers.FindChecked(TempLayerName);
+        const TConstArrayView<uint8> LayerWeights = WeightLayers.GetLayer(Index);
+        LayerInfo.LayerData = TArray<uint8>(LayerWeights.GetData(), LayerWeights.Num());
 
         if (LayerNames.IsValidIndex(Index))
         {
@@ -0,0 +1,114 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Utils/OCGMedianFilter.h"
+
+#include "Utils/OCGParallelUtils.h"
+
+namespace
+{
+	constexpr int32 NumCoarseBins = 256;
+	constexpr int32 NumFineBins = 65536;
+
+	// Histogram of the current window. The coarse level counts the high byte of each value, the fine level the full value.
+	// Perreault & Hebert keep a histogram per column to reach O(1) updates, but with 16 bit values that would be
+	// 65536 bins for every column of the map, so only the window histogram is kept and updated column by column (Huang)
+	struct FWindowHistogram
+	{
+		TArray<int32> Coarse;
+		TArray<int32> Fine;
+
+		FWindowHistogram()
+		{
+			Coarse.Init(0, NumCoarseBins);
+			Fine.Init(0, NumFineBins);
+		}
+
+		FORCEINLINE void Add(const uint16 Value)
+		{
+			++Coarse[Value >> 8];
+			++Fine[Value];
+		}
+
+		FORCEINLINE void Remove(const uint16 Value)
+		{
+			--Coarse[Value >> 8];
+			--Fine[Value];
+		}
+
+		// Value at position Rank (0 based) of the sorted window
+		uint16 FindValue(int32 Rank) const
+		{
+			int32 CoarseBin = 0;
+			while (Rank >= Coarse[CoarseBin])
+			{
+				Rank -= Coarse[CoarseBin];
+				++CoarseBin;
+			}
+
+			int32 FineBin = CoarseBin << 8;
+			while (Rank >= Fine[FineBin])
+			{
+				Rank -= Fine[FineBin];
+				++FineBin;
+			}
+			return static_cast<uint16>(FineBin);
+		}
+	};
+}
+
+void OCGMedianFilter::MedianFilter(const TArray<uint16>& InMap, TArray<uint16>& OutMap, const int32 Width, const int32 Height, const int32 Radius,
+	const int32 MaxThreads)
+{
+	OutMap = InMap;
+	if (Radius <= 0 || Width <= 2 * Radius || Height <= 2 * Radius || InMap.Num() != Width * Height)
+		return;
+
+	const int32 KernelSize = 2 * Radius + 1;
+	const int32 MedianRank = KernelSize * KernelSize / 2;
+	const int32 FirstRow = Radius;
+	const int32 NumRows = Height - 2 * Radius;
+
+	FOCGParallelUtils::ParallelForRows(NumRows, MaxThreads, [&](const int32 StartRow, const int32 EndRow)
+	{
+		FWindowHistogram Histogram;
+
+		auto AddColumn = [&](const int32 x, const int32 y)
+		{
+			for (int32 wy = y - Radius; wy <= y + Radius; ++wy)
+			{
+				Histogram.Add(InMap[wy * Width + x]);
+			}
+		};
+		auto RemoveColumn = [&](const int32 x, const int32 y)
+		{
+			for (int32 wy = y - Radius; wy <= y + Radius; ++wy)
+			{
+				Histogram.Remove(InMap[wy * Width + x]);
+			}
+		};
+
+		for (int32 y = FirstRow + StartRow; y < FirstRow + EndRow; ++y)
+		{
+			// Window of the first pixel in the row
+			for (int32 wx = 0; wx < KernelSize; ++wx)
+			{
+				AddColumn(wx, y);
+			}
+			OutMap[y * Width + Radius] = Histogram.FindValue(MedianRank);
+
+			// Slide to the right
+			for (int32 x = Radius + 1; x < Width - Radius; ++x)
+			{
+				RemoveColumn(x - Radius - 1, y);
+				AddColumn(x + Radius, y);
+				OutMap[y * Width + x] = Histogram.FindValue(MedianRank);
+			}
+
+			// Empty the histogram for the next row, cheaper than clearing 65536 bins
+			for (int32 wx = Width - KernelSize; wx < Width; ++wx)
+			{
+				RemoveColumn(wx, y);
+			}
+		}
+	});
+}
@@ -0,0 +1,13 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Utils/OCGMemoryUtils.h"
+
+LLM_DEFINE_TAG(OCGMapGeneration);
+
+void FOCGScratchBufferPool::Empty()
+{
+	FreeFloatBuffers.Empty();
+	FreeUInt16Buffers.Empty();
+	PooledBytes = 0;
+	PeakBytes = LiveBytes;
+}
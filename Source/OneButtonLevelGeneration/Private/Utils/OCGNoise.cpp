@@ -0,0 +1,207 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Utils/OCGNoise.h"
+
+namespace
+{
+	// Ken Perlin's reference permutation
+	const uint8 Permutation[256] =
+	{
+		151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225,
+		140, 36, 103, 30, 69, 142, 8, 99, 37, 240, 21, 10, 23, 190, 6, 148,
+		247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117, 35, 11, 32,
+		57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175,
+		74, 165, 71, 134, 139, 48, 27, 166, 77, 146, 158, 231, 83, 111, 229, 122,
+		60, 211, 133, 230, 220, 105, 92, 41, 55, 46, 245, 40, 244, 102, 143, 54,
+		65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89, 18, 169,
+		200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64,
+		52, 217, 226, 250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212,
+		207, 206, 59, 227, 47, 16, 58, 17, 182, 189, 28, 42, 223, 183, 170, 213,
+		119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43, 172, 9,
+		129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104,
+		218, 246, 97, 228, 251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241,
+		81, 51, 145, 235, 249, 14, 239, 107, 49, 192, 214, 31, 181, 199, 106, 157,
+		184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254, 138, 236, 205, 93,
+		222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180,
+	};
+
+	// Gradient of each hash bucket (corners and major axes), keeps the result in -1~1 without extra scaling
+	const float GradientX[8] = { 1.f, 1.f, 0.f, -1.f, -1.f, -1.f, 0.f, 1.f };
+	const float GradientY[8] = { 0.f, 1.f, 1.f, 1.f, 0.f, -1.f, -1.f, -1.f };
+
+	// Samples per octave batch in FractalRow, keeps the octave buffer on the stack
+	constexpr int32 FractalChunkSize = 256;
+
+	FORCEINLINE float Fade(const float T)
+	{
+		return T * T * T * (T * (T * 6.f - 15.f) + 10.f);
+	}
+
+	FORCEINLINE float LerpNoise(const float A, const float B, const float Alpha)
+	{
+		return A + Alpha * (B - A);
+	}
+
+	FORCEINLINE float Gradient(const int32 Hash, const float X, const float Y)
+	{
+		return GradientX[Hash & 7] * X + GradientY[Hash & 7] * Y;
+	}
+
+	// Hashes of the 4 lattice corners of cell (CellX, CellY)
+	FORCEINLINE void HashCorners(const int32 CellX, const int32 CellY, int32& OutH00, int32& OutH10, int32& OutH01, int32& OutH11)
+	{
+		const int32 Xi = CellX & 255;
+		const int32 Yi = CellY & 255;
+		const int32 A = Permutation[Xi] + Yi;
+		const int32 B = Permutation[(Xi + 1) & 255] + Yi;
+		OutH00 = Permutation[A & 255];
+		OutH01 = Permutation[(A + 1) & 255];
+		OutH10 = Permutation[B & 255];
+		OutH11 = Permutation[(B + 1) & 255];
+	}
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	// Evaluates 4 samples at once. Lattice hashing is done per lane, the rest runs in vector registers
+	// with the same operation order as OCGNoise::Perlin2D so both paths return identical values
+	FORCEINLINE VectorRegister4Float Perlin2D4(const VectorRegister4Float& X, const VectorRegister4Float& Y)
+	{
+		const VectorRegister4Float FloorX = VectorFloor(X);
+		const VectorRegister4Float FloorY = VectorFloor(Y);
+
+		alignas(16) float CellX[4];
+		alignas(16) float CellY[4];
+		VectorStoreAligned(FloorX, CellX);
+		VectorStoreAligned(FloorY, CellY);
+
+		alignas(16) float G00X[4], G00Y[4], G10X[4], G10Y[4], G01X[4], G01Y[4], G11X[4], G11Y[4];
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			int32 H00, H10, H01, H11;
+			HashCorners(static_cast<int32>(CellX[Lane]), static_cast<int32>(CellY[Lane]), H00, H10, H01, H11);
+			G00X[Lane] = GradientX[H00 & 7]; G00Y[Lane] = GradientY[H00 & 7];
+			G10X[Lane] = GradientX[H10 & 7]; G10Y[Lane] = GradientY[H10 & 7];
+			G01X[Lane] = GradientX[H01 & 7]; G01Y[Lane] = GradientY[H01 & 7];
+			G11X[Lane] = GradientX[H11 & 7]; G11Y[Lane] = GradientY[H11 & 7];
+		}
+
+		const VectorRegister4Float One = VectorOneFloat();
+		const VectorRegister4Float FracX = VectorSubtract(X, FloorX);
+		const VectorRegister4Float FracY = VectorSubtract(Y, FloorY);
+		const VectorRegister4Float FracXm1 = VectorSubtract(FracX, One);
+		const VectorRegister4Float FracYm1 = VectorSubtract(FracY, One);
+
+		auto Grad = [](const float* GX, const float* GY, const VectorRegister4Float& DX, const VectorRegister4Float& DY)
+		{
+			return VectorAdd(VectorMultiply(VectorLoadAligned(GX), DX), VectorMultiply(VectorLoadAligned(GY), DY));
+		};
+		const VectorRegister4Float N00 = Grad(G00X, G00Y, FracX, FracY);
+		const VectorRegister4Float N10 = Grad(G10X, G10Y, FracXm1, FracY);
+		const VectorRegister4Float N01 = Grad(G01X, G01Y, FracX, FracYm1);
+		const VectorRegister4Float N11 = Grad(G11X, G11Y, FracXm1, FracYm1);
+
+		const VectorRegister4Float Six = VectorSetFloat1(6.f);
+		const VectorRegister4Float Fifteen = VectorSetFloat1(15.f);
+		const VectorRegister4Float Ten = VectorSetFloat1(10.f);
+		auto FadeVector = [&](const VectorRegister4Float& T)
+		{
+			const VectorRegister4Float T3 = VectorMultiply(VectorMultiply(T, T), T);
+			const VectorRegister4Float Inner = VectorAdd(VectorMultiply(T, VectorSubtract(VectorMultiply(T, Six), Fifteen)), Ten);
+			return VectorMultiply(T3, Inner);
+		};
+		const VectorRegister4Float U = FadeVector(FracX);
+		const VectorRegister4Float V = FadeVector(FracY);
+
+		auto LerpVector = [](const VectorRegister4Float& A, const VectorRegister4Float& B, const VectorRegister4Float& Alpha)
+		{
+			return VectorAdd(A, VectorMultiply(Alpha, VectorSubtract(B, A)));
+		};
+		return LerpVector(LerpVector(N00, N10, U), LerpVector(N01, N11, U), V);
+	}
+#endif
+}
+
+float OCGNoise::Perlin2D(const float X, const float Y)
+{
+	const float FloorX = FMath::FloorToFloat(X);
+	const float FloorY = FMath::FloorToFloat(Y);
+
+	int32 H00, H10, H01, H11;
+	HashCorners(static_cast<int32>(FloorX), static_cast<int32>(FloorY), H00, H10, H01, H11);
+
+	const float FracX = X - FloorX;
+	const float FracY = Y - FloorY;
+	const float FracXm1 = FracX - 1.f;
+	const float FracYm1 = FracY - 1.f;
+
+	const float U = Fade(FracX);
+	const float V = Fade(FracY);
+
+	return LerpNoise(
+		LerpNoise(Gradient(H00, FracX, FracY), Gradient(H10, FracXm1, FracY), U),
+		LerpNoise(Gradient(H01, FracX, FracYm1), Gradient(H11, FracXm1, FracYm1), U),
+		V);
+}
+
+void OCGNoise::PerlinRow(const FVector2f& Offset, const float Scale, const int32 StartX, const int32 Y, const int32 Count, float* OutValues)
+{
+	const float SampleY = Y * Scale + Offset.Y;
+	int32 Index = 0;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	const VectorRegister4Float VecScale = VectorSetFloat1(Scale);
+	const VectorRegister4Float VecOffsetX = VectorSetFloat1(Offset.X);
+	const VectorRegister4Float VecSampleY = VectorSetFloat1(SampleY);
+	const VectorRegister4Float LaneOffsets = MakeVectorRegisterFloat(0.f, 1.f, 2.f, 3.f);
+	for (; Index + 4 <= Count; Index += 4)
+	{
+		const VectorRegister4Float Coord = VectorAdd(VectorSetFloat1(static_cast<float>(StartX + Index)), LaneOffsets);
+		const VectorRegister4Float SampleX = VectorAdd(VectorMultiply(Coord, VecScale), VecOffsetX);
+		VectorStore(Perlin2D4(SampleX, VecSampleY), OutValues + Index);
+	}
+#endif
+
+	// Remaining samples, or the whole row when vector intrinsics are not available
+	for (; Index < Count; ++Index)
+	{
+		const float SampleX = static_cast<float>(StartX + Index) * Scale + Offset.X;
+		OutValues[Index] = Perlin2D(SampleX, SampleY);
+	}
+}
+
+void OCGNoise::FractalRow(const FOCGFractalNoiseSettings& Settings, const int32 StartX, const int32 Y, const int32 Count, float* OutValues)
+{
+	FMemory::Memzero(OutValues, Count * sizeof(float));
+
+	alignas(16) float OctaveValues[FractalChunkSize];
+	float Amplitude = 1.f;
+	float Frequency = 1.f;
+	float MaxPossibleAmplitude = 0.f;
+
+	for (int32 Octave = 0; Octave < Settings.Octaves; ++Octave)
+	{
+		const float OctaveScale = Settings.Scale * Frequency;
+		for (int32 ChunkStart = 0; ChunkStart < Count; ChunkStart += FractalChunkSize)
+		{
+			const int32 ChunkCount = FMath::Min(FractalChunkSize, Count - ChunkStart);
+			PerlinRow(Settings.Offset, OctaveScale, StartX + ChunkStart, Y, ChunkCount, OctaveValues);
+
+			float* ChunkValues = OutValues + ChunkStart;
+			for (int32 i = 0; i < ChunkCount; ++i)
+			{
+				ChunkValues[i] += OctaveValues[i] * Amplitude;
+			}
+		}
+		MaxPossibleAmplitude += Amplitude;
+		Amplitude *= Settings.Persistence;
+		Frequency *= Settings.Lacunarity;
+	}
+
+	// Normalize to -1~1
+	if (MaxPossibleAmplitude > 0.f)
+	{
+		for (int32 i = 0; i < Count; ++i)
+		{
+			OutValues[i] /= MaxPossibleAmplitude;
+		}
+	}
+}
@@ -0,0 +1,143 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Utils/OCGPathSimplify.h"
+
+namespace
+{
+	struct FIndexRange
+	{
+		int32 First;
+		int32 Last;
+	};
+
+	struct FAreaNode
+	{
+		float Area;
+		int32 Index;
+	};
+
+	FORCEINLINE float TriangleArea(const FVector& A, const FVector& B, const FVector& C)
+	{
+		return 0.5f * static_cast<float>(FVector::CrossProduct(B - A, C - A).Size());
+	}
+
+	// Short paths keep every point
+	bool InitKeep(const int32 NumPoints, TBitArray<>& OutKeep)
+	{
+		OutKeep.Init(NumPoints < 3, NumPoints);
+		if (NumPoints < 3)
+			return false;
+		OutKeep[0] = true;
+		OutKeep[NumPoints - 1] = true;
+		return true;
+	}
+}
+
+void OCGPathSimplify::RamerDouglasPeucker(const TConstArrayView<FVector> Points, const float Epsilon, TBitArray<>& OutKeep)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(OCGPathSimplify::RamerDouglasPeucker);
+
+	if (!InitKeep(Points.Num(), OutKeep))
+		return;
+
+	TArray<FIndexRange> Stack;
+	Stack.Add({ 0, Points.Num() - 1 });
+	FIndexRange Range;
+	while (Stack.Num() > 0)
+	{
+		Range = Stack.Pop(EAllowShrinking::No);
+		if (Range.Last - Range.First < 2)
+			continue;
+
+		const FVector& First = Points[Range.First];
+		const FVector& Last = Points[Range.Last];
+		float MaxDistance = 0.f;
+		int32 MaxIndex = INDEX_NONE;
+		for (int32 Index = Range.First + 1; Index < Range.Last; ++Index)
+		{
+			const float Distance = FMath::PointDistToSegment(Points[Index], First, Last);
+			if (Distance > MaxDistance)
+			{
+				MaxDistance = Distance;
+				MaxIndex = Index;
+			}
+		}
+
+		if (MaxIndex != INDEX_NONE && MaxDistance > Epsilon)
+		{
+			OutKeep[MaxIndex] = true;
+			Stack.Add({ Range.First, MaxIndex });
+			Stack.Add({ MaxIndex, Range.Last });
+		}
+	}
+}
+
+void OCGPathSimplify::Visvalingam(const TConstArrayView<FVector> Points, const float MinArea, TBitArray<>& OutKeep)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(OCGPathSimplify::Visvalingam);
+
+	const int32 NumPoints = Points.Num();
+	if (!InitKeep(NumPoints, OutKeep))
+		return;
+
+	// Remaining points form a linked list, a point's area is the triangle with its current neighbors
+	TArray<int32> Prev;
+	TArray<int32> Next;
+	TArray<float> Areas;
+	Prev.SetNumUninitialized(NumPoints);
+	Next.SetNumUninitialized(NumPoints);
+	Areas.SetNumUninitialized(NumPoints);
+
+	auto AreaPredicate = [](const FAreaNode& A, const FAreaNode& B)
+	{
+		return A.Area < B.Area || (A.Area == B.Area && A.Index < B.Index);
+	};
+	TArray<FAreaNode> Heap;
+	Heap.Reserve(NumPoints);
+	for (int32 Index = 0; Index < NumPoints; ++Index)
+	{
+		Prev[Index] = Index - 1;
+		Next[Index] = Index + 1;
+		if (Index > 0 && Index < NumPoints - 1)
+		{
+			OutKeep[Index] = true;
+			Areas[Index] = TriangleArea(Points[Index - 1], Points[Index], Points[Index + 1]);
+			Heap.Add({ Areas[Index], Index });
+		}
+	}
+	Heap.Heapify(AreaPredicate);
+
+	FAreaNode Current;
+	while (Heap.Num() > 0)
+	{
+		Heap.HeapPop(Current, AreaPredicate, EAllowShrinking::No);
+		// Stale entry of a point that was dropped or whose neighbors changed after it was pushed
+		if (!OutKeep[Current.Index] || Current.Area != Areas[Current.Index])
+			continue;
+		if (Current.Area >= MinArea)
+			break;
+
+		OutKeep[Current.Index] = false;
+		const int32 PrevIndex = Prev[Current.Index];
+		const int32 NextIndex = Next[Current.Index];
+		Next[PrevIndex] = NextIndex;
+		Prev[NextIndex] = PrevIndex;
+
+		for (const int32 Neighbor : { PrevIndex, NextIndex })
+		{
+			if (Neighbor == 0 || Neighbor == NumPoints - 1)
+				continue;
+			Areas[Neighbor] = FMath::Max(TriangleArea(Points[Prev[Neighbor]], Points[Neighbor], Points[Next[Neighbor]]), Current.Area);
+			Heap.HeapPush({ Areas[Neighbor], Neighbor }, AreaPredicate);
+		}
+	}
+}
+
+void OCGPathSimplify::GatherKept(const TConstArrayView<FVector> Points, const TBitArray<>& Keep, TArray<FVector>& OutPoints)
+{
+	OutPoints.Reset(Keep.CountSetBits());
+	for (TConstSetBitIterator<> It(Keep); It; ++It)
+	{
+		OutPoints.Add(Points[It.GetIndex()]);
+	}
+}
@@ -0,0 +1,206 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Utils/OCGRegionTable.h"
+
+#include "Utils/OCGParallelUtils.h"
+
+namespace
+{
+	// Parents always have a smaller index than their children, so a forward scan can flatten the forest
+	FORCEINLINE int32 FindRoot(TArray<int32>& Parents, int32 Index)
+	{
+		while (Parents[Index] != Index)
+		{
+			// Path halving
+			Parents[Index] = Parents[Parents[Index]];
+			Index = Parents[Index];
+		}
+		return Index;
+	}
+
+	FORCEINLINE void Union(TArray<int32>& Parents, const int32 A, const int32 B)
+	{
+		const int32 RootA = FindRoot(Parents, A);
+		const int32 RootB = FindRoot(Parents, B);
+		if (RootA < RootB)
+		{
+			Parents[RootB] = RootA;
+		}
+		else if (RootB < RootA)
+		{
+			Parents[RootA] = RootB;
+		}
+	}
+}
+
+void FOCGRegionTable::Build(const TArray<uint8>& InClassMap, const TArray<uint16>& InHeightMap, const FIntPoint& InResolution, const int32 MaxThreads)
+{
+	Empty();
+
+	const int32 Width = InResolution.X;
+	const int32 Height = InResolution.Y;
+	const int32 NumPixels = Width * Height;
+	if (NumPixels <= 0 || InClassMap.Num() != NumPixels || InHeightMap.Num() != NumPixels)
+		return;
+
+	Resolution = InResolution;
+	RegionMap.SetNumUninitialized(NumPixels);
+	TArray<int32>& Parents = RegionMap;
+
+	// 1. Label every row band on its own. A band only links pixels inside itself, so bands never touch the same parents
+	TArray<int32> BandStarts;
+	FCriticalSection BandLock;
+	FOCGParallelUtils::ParallelForRows(Height, MaxThreads, [&](const int32 StartY, const int32 EndY)
+	{
+		for (int32 y = StartY; y < EndY; ++y)
+		{
+			for (int32 x = 0; x < Width; ++x)
+			{
+				const int32 Index = y * Width + x;
+				Parents[Index] = Index;
+
+				const uint8 Class = InClassMap[Index];
+				if (x > 0 && InClassMap[Index - 1] == Class)
+				{
+					Union(Parents, Index, Index - 1);
+				}
+				if (y > StartY && InClassMap[Index - Width] == Class)
+				{
+					Union(Parents, Index, Index - Width);
+				}
+			}
+		}
+
+		FScopeLock Lock(&BandLock);
+		BandStarts.Add(StartY);
+	});
+
+	// 2. Merge regions across the first row of every band
+	for (const int32 StartY : BandStarts)
+	{
+		if (StartY == 0)
+			continue;
+		for (int32 x = 0; x < Width; ++x)
+		{
+			const int32 Index = StartY * Width + x;
+			if (InClassMap[Index - Width] == InClassMap[Index])
+			{
+				Union(Parents, Index, Index - Width);
+			}
+		}
+	}
+
+	// 3. Flatten in scan order. A parent is always visited before its children, so one lookup gives the root
+	// and roots receive compact region indices in the order they are found
+	for (int32 Index = 0; Index < NumPixels; ++Index)
+	{
+		const int32 Parent = Parents[Index];
+		if (Parent == Index)
+		{
+			FOCGRegion& Region = Regions.AddDefaulted_GetRef();
+			Region.Class = InClassMap[Index];
+			RegionMap[Index] = Regions.Num() - 1;
+		}
+		else
+		{
+			// The parent already holds its region index
+			RegionMap[Index] = RegionMap[Parent];
+		}
+	}
+
+	// 4. Region statistics
+	TArray<double> HeightSums;
+	HeightSums.Init(0.0, Regions.Num());
+	for (int32 y = 0; y < Height; ++y)
+	{
+		for (int32 x = 0; x < Width; ++x)
+		{
+			const int32 Index = y * Width + x;
+			const int32 RegionIndex = RegionMap[Index];
+			const uint16 PixelHeight = InHeightMap[Index];
+			FOCGRegion& Region = Regions[RegionIndex];
+
+			++Region.Area;
+			Region.MinHeight = FMath::Min(Region.MinHeight, PixelHeight);
+			Region.MaxHeight = FMath::Max(Region.MaxHeight, PixelHeight);
+			HeightSums[RegionIndex] += PixelHeight;
+			Region.Bounds.Min.X = FMath::Min(Region.Bounds.Min.X, x);
+			Region.Bounds.Min.Y = FMath::Min(Region.Bounds.Min.Y, y);
+			Region.Bounds.Max.X = FMath::Max(Region.Bounds.Max.X, x + 1);
+			Region.Bounds.Max.Y = FMath::Max(Region.Bounds.Max.Y, y + 1);
+		}
+	}
+
+	for (int32 RegionIndex = 0; RegionIndex < Regions.Num(); ++RegionIndex)
+	{
+		Regions[RegionIndex].MeanHeight = static_cast<float>(HeightSums[RegionIndex] / Regions[RegionIndex].Area);
+	}
+}
+
+void FOCGRegionTable::Empty()
+{
+	RegionMap.Empty();
+	Regions.Empty();
+	Resolution = FIntPoint::ZeroValue;
+}
+
+void FOCGRegionTable::Serialize(FArchive& Ar)
+{
+	// Loaded tables come from cache files that may be damaged, counts are checked against the bytes left before allocating
+	auto FitsInArchive = [&Ar](const int32 Num, const int64 BytesPerElement)
+	{
+		return Num >= 0 && (!Ar.IsLoading() || Num * BytesPerElement <= Ar.TotalSize() - Ar.Tell());
+	};
+	auto FailLoading = [this, &Ar]()
+	{
+		Ar.SetError();
+		Empty();
+	};
+
+	Ar << Resolution;
+
+	int32 NumPixels = RegionMap.Num();
+	Ar << NumPixels;
+	if (Ar.IsError() || !FitsInArchive(NumPixels, sizeof(int32)))
+	{
+		FailLoading();
+		return;
+	}
+	if (Ar.IsLoading())
+	{
+		RegionMap.SetNumUninitialized(NumPixels);
+	}
+	Ar.Serialize(RegionMap.GetData(), static_cast<int64>(NumPixels) * sizeof(int32));
+
+	// Bytes of one region as written below
+	constexpr int64 RegionSize = sizeof(uint8) + sizeof(int32) + 2 * sizeof(uint16) + sizeof(float) + 4 * sizeof(int32);
+	int32 NumRegions = Regions.Num();
+	Ar << NumRegions;
+	if (Ar.IsError() || !FitsInArchive(NumRegions, RegionSize))
+	{
+		FailLoading();
+		return;
+	}
+	if (Ar.IsLoading())
+	{
+		Regions.SetNum(NumRegions);
+	}
+	for (FOCGRegion& Region : Regions)
+	{
+		Ar << Region.Class << Region.Area << Region.MinHeight << Region.MaxHeight << Region.MeanHeight;
+		Ar << Region.Bounds.Min.X << Region.Bounds.Min.Y << Region.Bounds.Max.X << Region.Bounds.Max.Y;
+	}
+
+	if (Ar.IsLoading())
+	{
+		bool bValid = !Ar.IsError() && RegionMap.Num() == Resolution.X * Resolution.Y;
+		for (int32 Index = 0; bValid && Index < RegionMap.Num(); ++Index)
+		{
+			bValid = RegionMap[Index] >= 0 && RegionMap[Index] < NumRegions;
+		}
+		if (!bValid)
+		{
+			FailLoading();
+		}
+	}
+}
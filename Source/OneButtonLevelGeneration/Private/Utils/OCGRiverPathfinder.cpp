@@ -0,0 +1,144 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#include "Utils/OCGRiverPathfinder.h"
+
+#include "Algo/Reverse.h"
+#include "Utils/OCGDistanceTransform.h"
+
+namespace
+{
+	// Climbing one pixel size of height costs as much as this many pixels of flat travel, rivers avoid ridges
+	// instead of crossing them on the shortest line to the sea
+	constexpr float UphillCostPerPixelRise = 10.f;
+
+	struct FNeighborOffset
+	{
+		int32 DX;
+		int32 DY;
+		float Length;
+	};
+
+	constexpr FNeighborOffset NeighborOffsets[] =
+	{
+		{ -1, -1, UE_SQRT_2 }, { 0, -1, 1.f }, { 1, -1, UE_SQRT_2 },
+		{ -1,  0, 1.f },                        { 1,  0, 1.f },
+		{ -1,  1, UE_SQRT_2 }, { 0,  1, 1.f }, { 1,  1, UE_SQRT_2 },
+	};
+}
+
+void FOCGRiverCostField::Build(TArray<float>&& InHeights, const FIntPoint& InResolution, const float InSeaHeight, const float InPixelSize,
+	const int32 MaxThreads)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FOCGRiverCostField::Build);
+
+	Resolution = InResolution;
+	Heights = MoveTemp(InHeights);
+	SeaHeight = InSeaHeight;
+	UphillCostScale = InPixelSize > UE_KINDA_SMALL_NUMBER ? UphillCostPerPixelRise / InPixelSize : 0.f;
+	check(Heights.Num() == Resolution.X * Resolution.Y);
+
+	TArray<bool> SeaMask;
+	SeaMask.SetNumUninitialized(Heights.Num());
+	bHasSea = false;
+	for (int32 Index = 0; Index < Heights.Num(); ++Index)
+	{
+		SeaMask[Index] = IsSea(Index);
+		bHasSea |= SeaMask[Index];
+	}
+
+	OCGDistanceTransform::EuclideanDistance(SeaMask, Resolution.X, Resolution.Y, MaxThreads, SeaDistance);
+}
+
+void FOCGRiverPathfinder::Reset(const int32 NumPixels)
+{
+	if (Stamps.Num() != NumPixels)
+	{
+		Costs.SetNumUninitialized(NumPixels);
+		Parents.SetNumUninitialized(NumPixels);
+		Stamps.Init(0, NumPixels);
+		CurrentStamp = 0;
+	}
+
+	// On wrap around old stamps would look current again
+	if (++CurrentStamp == 0)
+	{
+		FMemory::Memzero(Stamps.GetData(), Stamps.Num() * sizeof(uint32));
+		CurrentStamp = 1;
+	}
+	OpenList.Reset();
+	NumExpanded = 0;
+}
+
+bool FOCGRiverPathfinder::FindPath(const FOCGRiverCostField& Field, const FIntPoint& Start, TArray<FIntPoint>& OutPath)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FOCGRiverPathfinder::FindPath);
+
+	OutPath.Reset();
+	const int32 Width = Field.Resolution.X;
+	const int32 Height = Field.Resolution.Y;
+	if (!Field.HasSea() || Start.X < 0 || Start.X >= Width || Start.Y < 0 || Start.Y >= Height)
+		return false;
+
+	Reset(Field.Num());
+
+	// Lower priority first, on ties the node further along its path, which keeps A* from widening on plateaus
+	auto OpenListPredicate = [](const FOpenNode& A, const FOpenNode& B)
+	{
+		return A.Priority < B.Priority || (A.Priority == B.Priority && A.Cost > B.Cost);
+	};
+
+	const int32 StartIndex = Start.Y * Width + Start.X;
+	Costs[StartIndex] = 0.f;
+	Parents[StartIndex] = INDEX_NONE;
+	Stamps[StartIndex] = CurrentStamp;
+	OpenList.HeapPush({ Field.SeaDistance[StartIndex], 0.f, StartIndex }, OpenListPredicate);
+
+	int32 GoalIndex = INDEX_NONE;
+	FOpenNode Current;
+	while (OpenList.Num() > 0)
+	{
+		OpenList.HeapPop(Current, OpenListPredicate, EAllowShrinking::No);
+		// Stale entry of a pixel that was reached cheaper after it was pushed
+		if (Current.Cost > Costs[Current.Index])
+			continue;
+
+		++NumExpanded;
+		if (Field.IsSea(Current.Index))
+		{
+			GoalIndex = Current.Index;
+			break;
+		}
+
+		const int32 X = Current.Index % Width;
+		const int32 Y = Current.Index / Width;
+		const float CurrentHeight = Field.Heights[Current.Index];
+		for (const FNeighborOffset& Offset : NeighborOffsets)
+		{
+			const int32 NX = X + Offset.DX;
+			const int32 NY = Y + Offset.DY;
+			if (NX < 0 || NX >= Width || NY < 0 || NY >= Height)
+				continue;
+
+			const int32 NeighborIndex = NY * Width + NX;
+			const float Rise = FMath::Max(Field.Heights[NeighborIndex] - CurrentHeight, 0.f);
+			const float NewCost = Current.Cost + Offset.Length + Rise * Field.UphillCostScale;
+			if (Stamps[NeighborIndex] == CurrentStamp && NewCost >= Costs[NeighborIndex])
+				continue;
+
+			Stamps[NeighborIndex] = CurrentStamp;
+			Costs[NeighborIndex] = NewCost;
+			Parents[NeighborIndex] = Current.Index;
+			OpenList.HeapPush({ NewCost + Field.SeaDistance[NeighborIndex], NewCost, NeighborIndex }, OpenListPredicate);
+		}
+	}
+
+	if (GoalIndex == INDEX_NONE)
+		return false;
+
+	for (int32 Index = GoalIndex; Index != INDEX_NONE; Index = Parents[Index])
+	{
+		OutPath.Add(FIntPoint(Index % Width, Index / Width));
+	}
+	Algo::Reverse(OutPath);
+	return true;
+}
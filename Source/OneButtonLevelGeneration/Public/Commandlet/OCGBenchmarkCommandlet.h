@@ -0,0 +1,36 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "OCGBenchmarkCommandlet.generated.h"
+
+class FJsonObject;
+class UMapPreset;
+
+/**
+ * Times the map generation stages of a preset without the editor UI and writes the result as JSON.
+ *
+ * UnrealEditor-Cmd <Project> -run=OCGBenchmark -Preset=/Game/Path/MapPreset [-Resolutions=1009x1009,2017x2017]
+ *     [-Seeds=1337,42] [-Repeats=1] [-Output=<File.json>] -nullrhi -unattended
+ *
+ * Every resolution / seed pair runs the CPU map stages (height, temperature, humidity, biome, smoothing, erosion)
+ * on a transient copy of the preset. The JSON holds the time of every stage and CRC32 checksums of the height,
+ * temperature and humidity maps, so runs can be compared for performance and determinism.
+ */
+UCLASS()
+class ONEBUTTONLEVELGENERATION_API UOCGBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UOCGBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	static bool ParseResolutions(const FString& InText, TArray<FIntPoint>& OutResolutions);
+	static bool ParseSeeds(const FString& InText, TArray<int32>& OutSeeds);
+	TSharedPtr<FJsonObject> RunBenchmark(const UMapPreset* SourcePreset, const FIntPoint& Resolution, int32 Seed, int32 Repeat) const;
+};
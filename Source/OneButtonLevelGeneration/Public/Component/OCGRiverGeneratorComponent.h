@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Utils/OCGElevationIndex.h"
+#include "Utils/OCGRiverPathfinder.h"
 #include "OCGRiverGeneratorComponent.generated.h"
 
 class AOCGLevelGenerator;
@@ -45,14 +47,18 @@ private:
 	void ClearAllRivers();
 
 	FVector GetLandscapePointWorldPosition(const FIntPoint& MapPoint, const FVector& LandscapeOrigin, const FVector& LandscapeExtent) const;
+	// Samples the landscape height of every map pixel once for the river searches
+	// Rebuilds the river cost field from the height map when the height map, the sea height or the landscape placement changed
+	void UpdateRiverCostField(const FVector& LandscapeExtent);
 	
 	void SetDefaultRiverProperties(AWaterBodyRiver* InRiverActor, const TArray<FVector>& InRiverPath);
 	// helper functions
 	FIntPoint GetRandomStartPoint(int RiverIndex);
 
-	void SimplifyPathRDP(const TArray<FVector>& InPoints, TArray<FVector>& OutPoints, float Epsilon);
+	void SimplifyRiverPath(const TArray<FVector>& InPoints, TArray<FVector>& OutPoints) const;
 
-	void CacheRiverStartPoints();
+	// Rebuilds the source candidates when the height map changed and converts the source elevation to a height map value
+	void UpdateRiverStartIndex();
 
 	UPROPERTY(Transient)
 	TObjectPtr<UMapPreset> MapPreset;
@@ -69,8 +75,20 @@ private:
 	UPROPERTY(Transient)
 	TObjectPtr<ALandscape> TargetLandscape;
 	
-	TSet<FIntPoint> UsedRiverStartPoints;
-	TArray<FIntPoint> CachedRiverStartPoints;
+	// Height map pixels sorted by height, kept until the preset gets a new height map
+	FOCGElevationIndex RiverStartIndex;
+	TWeakObjectPtr<UMapPreset> RiverStartIndexPreset;
+	uint32 RiverStartIndexRevision = 0;
+	// Heights and distance to the sea shared by every river search, kept like RiverStartIndex
+	FOCGRiverCostField RiverCostField;
+	TWeakObjectPtr<UMapPreset> RiverCostFieldPreset;
+	uint32 RiverCostFieldRevision = 0;
+	// Sea height, pixel size, landscape Z location and Z scale the cost field was built with
+	FVector4f RiverCostFieldParams = FVector4f::Zero();
+	// Lowest height map value a river source may have
+	uint16 RiverSourceMinHeight = 0;
+	// Sources picked in this generation, later sources keep their distance from them
+	TArray<FIntPoint> UsedRiverStartPoints;
 
 	TArray<uint16> CachedRiverHeightMap;
 
@@ -85,9 +103,6 @@ private:
 
 	UPROPERTY()
 	bool bIsRiverExists = false;
-
-	UPROPERTY()
-	int32 CurrentRiverSeed = 0;
 };
 
 
@@ -28,7 +28,7 @@ namespace OCGMapDataUtils
 
 	UTexture2D* ImportTextureFromPNG(const FString& FileName);
 
-	bool ExportMap(const TArray<uint8>& InMap, const FIntPoint& Resolution, const FString& FileName);
+	bool ExportMap(TConstArrayView<uint8> InMap, const FIntPoint& Resolution, const FString& FileName);
 
 	bool ExportMap(const TArray<uint16>& InMap, const FIntPoint& Resolution, const FString& FileName);
 
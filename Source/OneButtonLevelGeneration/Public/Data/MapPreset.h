@@ -29,6 +29,31 @@ enum class ELandscapeQuadsPerSection : uint8
 	Q255 = 255  UMETA(DisplayName = "255"),
 };
 
+UENUM(BlueprintType)
+enum class EOCGErosionMethod : uint8
+{
+	Droplet		UMETA(DisplayName = "Droplet"),
+	PipeModel	UMETA(DisplayName = "Pipe Model"),
+};
+
+UENUM(BlueprintType)
+enum class EOCGRiverPlacement : uint8
+{
+	// Every river searches its own way to the sea from a random high start point
+	SourceSearch		UMETA(DisplayName = "Source Search"),
+	// Rivers follow the channels that drain the largest area, smaller ones join larger ones as tributaries
+	DrainageNetwork		UMETA(DisplayName = "Drainage Network"),
+};
+
+UENUM(BlueprintType)
+enum class EOCGRiverSimplification : uint8
+{
+	// Keeps the points farther than the epsilon from the simplified line
+	RamerDouglasPeucker	UMETA(DisplayName = "Ramer-Douglas-Peucker"),
+	// Drops the points spanning the smallest triangles with their neighbors, keeps the curves of meanders smoother
+	Visvalingam			UMETA(DisplayName = "Visvalingam"),
+};
+
 UCLASS(BlueprintType, meta = (DisplayName = "Map Preset"))
 class ONEBUTTONLEVELGENERATION_API UMapPreset : public UObject
 {
@@ -241,7 +266,7 @@ public:
 	// Threshold Angle of the slope of the landscape
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Height",
-		meta = (EditCondition = "bSmoothByMediumHeight", EditConditionHides, ClampMin = "0", ClampMax = "5")
+		meta = (EditCondition = "bSmoothByMediumHeight", EditConditionHides, ClampMin = "0", ClampMax = "32")
 	)
 	int32 MedianSmoothRadius = 3;
 
@@ -364,89 +389,153 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion")
 	bool bErosion = true;
 
+	// Droplet simulates single water particles, Pipe Model simulates water flowing over the whole grid at once
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
+		meta = (EditCondition = "bErosion", EditConditionHides)
+	)
+	EOCGErosionMethod ErosionMethod = EOCGErosionMethod::Droplet;
+
 	// More Iteration gives more erosion details
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "1", ClampMax = "1000000")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "1", ClampMax = "1000000")
 	)
 	int32 NumErosionIterations = 100000;
 
 	// Decides the size of erosion
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "2",ClampMax = "8")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "2",ClampMax = "8")
 	)
 	int32 ErosionRadius = 3;
 
+	// Simulates droplets of separate map tiles on multiple threads. Result is deterministic for a seed but differs slightly from the serial simulation,
+	// so it is off by default and existing presets keep their output
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides)
+	)
+	bool bParallelErosion = false;
+
 	// Larger Inertia gives more smooth flow of erosion droplets
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "0.0", ClampMax = "0.99")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "0.0", ClampMax = "0.99")
 	)
 	float DropletInertia = 0.25f; // 1에 가까울 수록 직진 성향 강해짐 0에 가까울수록 기울기에 따른 무작위 움직임
 
 	// Decides the capacity of sediment one droplet can have
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "0.0", ClampMax = "100.0")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "0.0", ClampMax = "100.0")
 	)
 	float SedimentCapacityFactor = 10.0f; // 흙 운반 용량 계수
 
 	// Decides the minimum capacity of sediment one droplet can have
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "0.0", ClampMax = "1.0")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "0.0", ClampMax = "1.0")
 	)
 	float MinSedimentCapacity = 0.01f; // 최소 운반 용량
 
 	// Decides the speed of erosion
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "0.0", ClampMax = "1.0")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "0.0", ClampMax = "1.0")
 	)
 	float ErodeSpeed = 0.3f; // 침식 속도
 
 	// Decides the speed of deposit
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "0.0", ClampMax = "1.0")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "0.0", ClampMax = "1.0")
 	)
 	float DepositSpeed = 0.3f; // 퇴적 속도
 
 	// Decides how fast the droplet evaporates
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "0.0", ClampMax = "1.0")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "0.0", ClampMax = "1.0")
 	)
 	float EvaporateSpeed = 0.01f; // 증발 속도
 
 	// Decides the gravity effect on droplets
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "0.0", ClampMax = "100.0")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "0.0", ClampMax = "100.0")
 	)
 	float Gravity = 9.8f;
 
 	// Decides the maximum lifetime of droplets
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "0.0", ClampMax = "512")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "0.0", ClampMax = "512")
 	)
 	int32 MaxDropletLifetime = 50;
 
 	// Decides the initial water volume of droplets
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "0.0", ClampMax = "10.0")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "0.0", ClampMax = "10.0")
 	)
 	float InitialWaterVolume = 0.5f;
 
 	// Decides the initial speed of droplets
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
-		meta = (EditCondition = "bErosion", EditConditionHides, ClampMin = "0.0", ClampMax = "20.0")
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::Droplet", EditConditionHides, ClampMin = "0.0", ClampMax = "20.0")
 	)
 	float InitialSpeed = 2.0f;
+
+	// Number of simulation steps of the pipe model. Every step updates all pixels
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::PipeModel", EditConditionHides, ClampMin = "1", ClampMax = "2000")
+	)
+	int32 PipeErosionIterations = 100;
+
+	// Simulated time of one step. Larger steps erode faster but less precisely
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::PipeModel", EditConditionHides, ClampMin = "0.001", ClampMax = "0.5")
+	)
+	float PipeTimeStep = 0.05f;
+
+	// Water (in cm) added to every pixel on each step
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::PipeModel", EditConditionHides, ClampMin = "0.0", ClampMax = "100.0")
+	)
+	float PipeRainAmount = 1.0f;
+
+	// Decides how much sediment flowing water can carry
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::PipeModel", EditConditionHides, ClampMin = "0.0", ClampMax = "10.0")
+	)
+	float PipeSedimentCapacity = 1.0f;
+
+	// Decides how fast water dissolves the ground
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::PipeModel", EditConditionHides, ClampMin = "0.0", ClampMax = "1.0")
+	)
+	float PipeDissolveRate = 0.3f;
+
+	// Decides how fast sediment settles when water slows down
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::PipeModel", EditConditionHides, ClampMin = "0.0", ClampMax = "1.0")
+	)
+	float PipeDepositRate = 0.3f;
+
+	// Decides how fast water evaporates
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "World Settings | Advanced | Erosion",
+		meta = (EditCondition = "bErosion && ErosionMethod == EOCGErosionMethod::PipeModel", EditConditionHides, ClampMin = "0.0", ClampMax = "10.0")
+	)
+	float PipeEvaporationRate = 0.5f;
 	//~ End UPROPERTY World Settings | Advanced | Erosion
 	//~ End UPROPERTY World Settings | Advanced
 
@@ -499,10 +588,17 @@ public:
 	)
 	int32 RiverCount = 1;
 
+	// How rivers are placed. Drainage Network does not use the river seed and the source elevation ratio
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "River Settings",
+		meta = (EditCondition = "bGenerateRiver", EditConditionHides)
+	)
+	EOCGRiverPlacement RiverPlacement = EOCGRiverPlacement::SourceSearch;
+
 	// Determines river's start point. 1.0 means the river will start at the highest point of the landscape, 0.5 means it will start at the middle height.
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "River Settings",
-		meta = (EditCondition = "bGenerateRiver", EditConditionHides, ClampMin = "0.5", ClampMax = "1.0", UIMin = "0.5",
+		meta = (EditCondition = "bGenerateRiver && RiverPlacement == EOCGRiverPlacement::SourceSearch", EditConditionHides, ClampMin = "0.5", ClampMax = "1.0", UIMin = "0.5",
 			UIMax = "1.0")
 	)
 	float RiverSourceElevationRatio = 0.8f;
@@ -515,6 +611,13 @@ public:
 	)
 	float RiverSplineSimplifyEpsilon = 200.f;
 
+	// How the river path is simplified. Visvalingam drops points whose triangle with its neighbors is smaller than a triangle with the epsilon as base and height
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "River Settings",
+		meta = (EditCondition = "bGenerateRiver", EditConditionHides)
+	)
+	EOCGRiverSimplification RiverSplineSimplification = EOCGRiverSimplification::RamerDouglasPeucker;
+
 	// Base of the river width. RiverWidthCurve value will be normalized and multiplied by this value to get the final width of the river.
 	UPROPERTY(
 		EditAnywhere, BlueprintReadWrite, Category = "River Settings",
@@ -625,6 +728,17 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OCG")
 	bool bExportMapTextures = false;
 
+	// Maximum number of threads used while generating maps. 0 uses every available core, 1 generates on a single thread
+	UPROPERTY(
+		EditAnywhere, BlueprintReadWrite, Category = "OCG",
+		meta = (ClampMin = "0", ClampMax = "256", UIMin = "0", UIMax = "64")
+	)
+	int32 MaxGenerationThreads = 0;
+
+	// Computes height and temperature maps in a single pass instead of two separate sweeps. Results are the same, only faster on large maps
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OCG")
+	bool bFuseHeightAndTemperaturePass = true;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "OCG")
 	TArray<FOCGBiomeSettings> Biomes;
 
@@ -638,6 +752,9 @@ public:
 	UPROPERTY()
 	TArray<uint16> HeightMapData;
 
+	// Bumped whenever HeightMapData is replaced, data derived from the height map compares it to know it is stale
+	uint32 HeightMapRevision = 0;
+
 	UPROPERTY()
 	TArray<uint16> TemperatureMapData;
 
@@ -0,0 +1,47 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Landscape paint weights of every biome layer in one planar allocation (layer x height x width).
+ * Layers are addressed by index, layer 0 is the water biome and layer N is MapPreset->Biomes[N - 1].
+ */
+class ONEBUTTONLEVELGENERATION_API FOCGWeightLayerBuffer
+{
+public:
+	// Allocates NumLayers zeroed layers of Resolution.X * Resolution.Y weights
+	void Init(int32 InNumLayers, const FIntPoint& InResolution);
+	void Empty();
+	// Reads or writes the layers, used by the map layer cache
+	void Serialize(FArchive& Ar);
+
+	FORCEINLINE int32 Num() const { return NumLayers; }
+	FORCEINLINE bool IsEmpty() const { return NumLayers == 0; }
+	FORCEINLINE const FIntPoint& GetResolution() const { return Resolution; }
+	FORCEINLINE int32 GetNumPixels() const { return Resolution.X * Resolution.Y; }
+
+	FORCEINLINE uint8* GetLayerData(const int32 LayerIndex)
+	{
+		check(LayerIndex >= 0 && LayerIndex < NumLayers);
+		return Data.GetData() + static_cast<int64>(LayerIndex) * GetNumPixels();
+	}
+
+	FORCEINLINE const uint8* GetLayerData(const int32 LayerIndex) const
+	{
+		check(LayerIndex >= 0 && LayerIndex < NumLayers);
+		return Data.GetData() + static_cast<int64>(LayerIndex) * GetNumPixels();
+	}
+
+	FORCEINLINE TArrayView<uint8> GetLayer(const int32 LayerIndex) { return TArrayView<uint8>(GetLayerData(LayerIndex), GetNumPixels()); }
+	FORCEINLINE TConstArrayView<uint8> GetLayer(const int32 LayerIndex) const { return TConstArrayView<uint8>(GetLayerData(LayerIndex), GetNumPixels()); }
+
+	// Default layer name used when the landscape material does not provide one
+	static FName GetDefaultLayerName(int32 LayerIndex);
+
+private:
+	TArray64<uint8> Data;
+	int32 NumLayers = 0;
+	FIntPoint Resolution = FIntPoint::ZeroValue;
+};
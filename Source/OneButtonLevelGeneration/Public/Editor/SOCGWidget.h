@@ -35,6 +35,13 @@ private:
 	bool IsPreviewMapEnabled() const;
 	bool IsGenerateEnabled() const;
 
+	// Progress row of the map generation running in the background
+	bool IsGeneratingMaps() const;
+	EVisibility GetMapGenerationVisibility() const;
+	TOptional<float> GetMapGenerationProgress() const;
+	FText GetMapGenerationStageText() const;
+	FReply OnCancelMapGenerationClicked();
+
 	void UpdateSelectedActor();
 	void SetSelectedActor(AOCGLevelGenerator* NewActor);
 
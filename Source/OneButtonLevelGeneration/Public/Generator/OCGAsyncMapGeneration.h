@@ -0,0 +1,62 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Generator/OCGMapGenerator.h"
+
+#include <atomic>
+
+class UMapPreset;
+
+/**
+ * Runs an FOCGMapGenerator on a background task graph thread while the editor keeps running.
+ *
+ * Launch snapshots the preset on the game thread. Progress and cancellation can be polled and requested from the game
+ * thread while the stages run. OnCompleted always runs on the game thread, also after a cancel, and is the place to
+ * apply the result to the preset and to create the landscape and actors.
+ */
+class ONEBUTTONLEVELGENERATION_API FOCGAsyncMapGeneration : public TSharedFromThis<FOCGAsyncMapGeneration>
+{
+public:
+	// bCompleted is false when the run was cancelled, Result is only filled when it completed
+	using FOnCompleted = TFunction<void(bool bCompleted, FOCGMapGenerationResult& Result)>;
+
+	// Generates from the preset, or from InHeightMap when it is not empty. StageCache may be null
+	static TSharedRef<FOCGAsyncMapGeneration> Launch(UMapPreset* MapPreset, TArray<uint16>&& InHeightMap,
+		const TSharedPtr<FOCGMapStageCache, ESPMode::ThreadSafe>& StageCache, FOnCompleted&& OnCompleted);
+
+	// Stops the run before its next stage
+	void Cancel();
+
+	FORCEINLINE bool IsRunning() const { return bRunning.load(); }
+	FORCEINLINE bool IsCancelRequested() const { return bCancelRequested.load(); }
+	// 0~1 fraction of finished stages
+	float GetProgress() const;
+	// Name of the running stage
+	FText GetStageText() const;
+
+private:
+	FOCGAsyncMapGeneration(UMapPreset* MapPreset, TArray<uint16>&& InHeightMap, const TSharedPtr<FOCGMapStageCache, ESPMode::ThreadSafe>& StageCache,
+		FOnCompleted&& InOnCompleted);
+
+	// Background thread
+	void Run();
+	bool OnProgress(const FText& StageName, int32 StageIndex, int32 NumStages);
+
+	// Game thread
+	void Complete(bool bCompleted);
+
+	TUniquePtr<FOCGMapGenerator> Generator;
+	TArray<uint16> InputHeightMap;
+	FOnCompleted OnCompleted;
+	FOCGMapGenerationResult Result;
+
+	std::atomic<bool> bRunning { true };
+	std::atomic<bool> bCancelRequested { false };
+	std::atomic<int32> CompletedStages { 0 };
+	int32 NumStages = 1;
+
+	mutable FCriticalSection StageTextLock;
+	FText StageText;
+};
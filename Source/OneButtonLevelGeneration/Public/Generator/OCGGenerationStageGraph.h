@@ -0,0 +1,62 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UMapPreset;
+
+// Steps of a level generation whose results can be kept when their inputs did not change
+enum class EOCGGenerationStage : uint8
+{
+	// Height map, and the temperature map computed from it
+	HeightAndTemperature,
+	Humidity,
+	// Biomes, height modification by biome, smoothing and erosion, the final maps
+	Maps,
+	Landscape,
+	// PCG on the landscape
+	Terrain,
+	Water,
+	River,
+	Num
+};
+
+// One key per stage, a key changes when anything the stage depends on changes
+struct FOCGStageKeys
+{
+	uint64 Keys[static_cast<int32>(EOCGGenerationStage::Num)] = {};
+
+	FORCEINLINE uint64 Get(const EOCGGenerationStage Stage) const { return Keys[static_cast<int32>(Stage)]; }
+	FORCEINLINE void Set(const EOCGGenerationStage Stage, const uint64 Key) { Keys[static_cast<int32>(Stage)] = Key; }
+	// 0 is never a valid key, so a stage that never ran is never up to date
+	FORCEINLINE bool Matches(const FOCGStageKeys& Other, const EOCGGenerationStage Stage) const
+	{
+		return Get(Stage) != 0 && Get(Stage) == Other.Get(Stage);
+	}
+};
+
+/**
+ * Dependencies between the generation stages. Every stage lists the preset properties it reads and the stages whose
+ * output it reads. A stage key hashes its properties together with the keys of its upstream stages, so editing a
+ * river property only changes the river key, while editing a humidity property changes every key from humidity on.
+ */
+namespace OCGStageGraph
+{
+	ONEBUTTONLEVELGENERATION_API const TCHAR* GetStageName(EOCGGenerationStage Stage);
+	// Preset properties read by the stage itself
+	ONEBUTTONLEVELGENERATION_API TConstArrayView<FName> GetPresetInputs(EOCGGenerationStage Stage);
+	// Stages whose output the stage reads
+	ONEBUTTONLEVELGENERATION_API TConstArrayView<EOCGGenerationStage> GetUpstreamStages(EOCGGenerationStage Stage);
+
+	// Hash of the preset inputs of every stage, not chained yet. Reads the preset through reflection, game thread only
+	ONEBUTTONLEVELGENERATION_API FOCGStageKeys HashPresetInputs(const UMapPreset* MapPreset);
+	// Combines every stage with its upstream stages. ExternalInputKey is mixed into the first stage, e.g. an imported height map
+	ONEBUTTONLEVELGENERATION_API FOCGStageKeys ChainStageKeys(const FOCGStageKeys& PresetInputHashes, uint64 ExternalInputKey = 0);
+	FORCEINLINE FOCGStageKeys ComputeStageKeys(const UMapPreset* MapPreset, const uint64 ExternalInputKey = 0)
+	{
+		return ChainStageKeys(HashPresetInputs(MapPreset), ExternalInputKey);
+	}
+
+	ONEBUTTONLEVELGENERATION_API uint64 HashHeightMap(const TArray<uint16>& InHeightMap);
+}
@@ -0,0 +1,213 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/OCGWeightLayerBuffer.h"
+#include "Generator/OCGGenerationStageGraph.h"
+#include "UObject/StrongObjectPtr.h"
+#include "Utils/OCGGenerationStats.h"
+#include "Utils/OCGMemoryUtils.h"
+#include "Utils/OCGRegionTable.h"
+
+class UMapPreset;
+struct FOCGBiomeSettings;
+struct FOCGBlurScratch;
+
+// Everything one map generation run produces
+struct ONEBUTTONLEVELGENERATION_API FOCGMapGenerationResult
+{
+	FIntPoint Resolution = FIntPoint::ZeroValue;
+	TArray<uint16> HeightMap;
+	TArray<uint16> TemperatureMap;
+	TArray<uint16> HumidityMap;
+	FOCGWeightLayerBuffer WeightLayers;
+	TArray<FColor> BiomeColorMap;
+	// Weight layer index of every pixel, 0 is the water biome
+	TArray<uint8> BiomeIndexMap;
+	// Connected biome areas of the terrain modification by biome
+	FOCGRegionTable BiomeRegions;
+	float CurMinHeight = 0.f;
+	float CurMaxHeight = 0.f;
+	float LandscapeZScale = 0.f;
+	float ZOffset = 0.f;
+	// Time and memory of every stage of the run
+	TArray<FOCGStageStats> Stages;
+};
+
+// Outputs of the first map stages, kept between runs so a run only recomputes the stages whose inputs changed
+struct FOCGMapStageCache
+{
+	uint64 HeightAndTemperatureKey = 0;
+	TArray<uint16> HeightMap;
+	TArray<uint16> TemperatureMap;
+	float MinTemp = 0.f;
+	float MaxTemp = 0.f;
+
+	uint64 HumidityKey = 0;
+	TArray<uint16> HumidityMap;
+	float MinHumidity = 0.f;
+	float MaxHumidity = 0.f;
+
+	FORCEINLINE int64 GetAllocatedSize() const
+	{
+		return HeightMap.GetAllocatedSize() + TemperatureMap.GetAllocatedSize() + HumidityMap.GetAllocatedSize();
+	}
+};
+
+// Called before every stage with its name and index, returning false cancels the run before that stage
+using FOCGMapGenerationProgress = TFunction<bool(const FText& StageName, int32 StageIndex, int32 NumStages)>;
+
+/**
+ * Synthesizes height, temperature, humidity and biome maps from a map preset without an actor, component or world.
+ *
+ * The constructor takes a snapshot of the preset settings and must run on the game thread. After that the generator
+ * only reads its own snapshot, so Generate can run on any thread and several generators can run at the same time.
+ * A single generator runs one generation at a time.
+ *
+ * With a stage cache, stages whose key (see OCGStageGraph) matches the cached one copy their output instead of
+ * running. The cache must not be shared by generators that run at the same time.
+ *
+ * When the map layer cache is enabled in UOCGDeveloperSettings, a run first looks for the maps of the same settings on
+ * disk (see OCGMapLayerCache) and stores its result there when it had to generate them.
+ */
+class ONEBUTTONLEVELGENERATION_API FOCGMapGenerator
+{
+public:
+	explicit FOCGMapGenerator(UMapPreset* InMapPreset, const TSharedPtr<FOCGMapStageCache, ESPMode::ThreadSafe>& InStageCache = nullptr);
+
+	// Number of progress callbacks of one Generate or GenerateWithHeightMap call
+	int32 GetNumStages(bool bWithHeightMap) const;
+	// Off for runs that have to run every stage, e.g. to time them
+	FORCEINLINE void SetUseLayerCache(const bool bInUseLayerCache) { bUseLayerCache = bInUseLayerCache; }
+
+	// Runs every map stage, false when the progress callback cancelled the run
+	bool Generate(FOCGMapGenerationResult& OutResult, const FOCGMapGenerationProgress& OnProgress = nullptr);
+	// Runs the stages that follow the height map on an imported height map of the preset resolution
+	bool GenerateWithHeightMap(const TArray<uint16>& InHeightMap, FOCGMapGenerationResult& OutResult, const FOCGMapGenerationProgress& OnProgress = nullptr);
+
+	// Runs serial and parallel droplet erosion on the height map and logs time and difference of both
+	void BenchmarkErosion(const TArray<uint16>& InHeightMap);
+
+	FORCEINLINE const UMapPreset* GetSettings() const { return Settings.Get(); }
+
+private:
+	static TStrongObjectPtr<UMapPreset> CreateSettingsSnapshot(UMapPreset* InMapPreset);
+
+	// Runs one stage as a named trace scope and a row of the stage stats, false when cancelled before the stage
+	bool RunStage(const TCHAR* StageName, const FOCGMapGenerationProgress& OnProgress, TFunctionRef<void()> Stage);
+	void MoveResultTo(FOCGMapGenerationResult& OutResult);
+
+	// Fills the result from the map layer cache, false when the maps have to be generated
+	bool LoadFromLayerCache(uint64 LayerCacheKey, FOCGMapGenerationResult& OutResult) const;
+	void StoreInLayerCache(uint64 LayerCacheKey, const FOCGMapGenerationResult& Result) const;
+	// Key of the current run in the map layer cache, 0 when the cache is not used
+	uint64 GetLayerCacheKey() const;
+
+	// Copies the stage output from the stage cache when its key matches, false when the stage has to run
+	bool RestoreHeightAndTemperature(const UMapPreset* MapPreset, TArray<uint16>& OutHeightMap, TArray<uint16>& OutTempMap);
+	void StoreHeightAndTemperature(const TArray<uint16>& InHeightMap, const TArray<uint16>& InTempMap);
+	bool RestoreHumidity(const UMapPreset* MapPreset, TArray<uint16>& OutHumidityMap);
+	void StoreHumidity(const TArray<uint16>& InHumidityMap);
+
+	float HeightMapToWorldHeight(uint16 Height) const;
+	uint16 WorldHeightToHeightMap(float Height) const;
+	// World height of the sea surface, the lowest height of the map when the map has no water
+	static float GetSeaLevelWorldHeight(const UMapPreset* MapPreset);
+
+	void Initialize(const UMapPreset* MapPreset);
+	void InitializeNoiseOffsets(const UMapPreset* MapPreset);
+	void GenerateHeightMap(const UMapPreset* MapPreset, const FIntPoint CurMapResolution, TArray<uint16>& OutHeightMap);
+	// Fills one row of 0~1 heights. Scratch must hold 2 * MapResolution.X floats
+	void CalculateHeightRow(const UMapPreset* MapPreset, const int32 InY, float* OutHeights, float* Scratch) const;
+	void GenerateTempMap(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap, TArray<uint16>& OutTempMap);
+	// Fused version of GenerateHeightMap + GenerateTempMap that evaluates both fields in a single pass over the map
+	void GenerateHeightAndTempMap(const UMapPreset* MapPreset, const FIntPoint CurMapResolution, TArray<uint16>& OutHeightMap, TArray<uint16>& OutTempMap);
+	void CalculateTemperatureRow(const UMapPreset* MapPreset, const int32 InY, const uint16* InHeightRow, float* NoiseScratch, float* OutTemps, float& InOutMinTemp, float& InOutMaxTemp) const;
+	void QuantizeTempMap(const UMapPreset* MapPreset, const TArray<float>& InTempMapFloat, const float GlobalMinTemp, const float GlobalMaxTemp, TArray<uint16>& OutTempMap);
+	void GenerateHumidityMap(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap, const TArray<uint16>& InTempMap, TArray<uint16>& OutHumidityMap);
+	void DecideBiome(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap, const TArray<uint16>& InTempMap, const TArray<uint16>& InHumidityMap, TArray<const FOCGBiomeSettings*>& OutBiomeMap, bool bExportMap = false, bool bBuildMountainRatio = false);
+	// bBuildMountainRatio also fills MountainRatioMap, only the terrain modification by biome reads it
+	void BlendBiome(const UMapPreset* MapPreset, bool bBuildMountainRatio);
+	void ExportMap(const UMapPreset* MapPreset, const TArray<uint16>& InMap, const FString& FileName) const;
+	void ExportMap(const UMapPreset* MapPreset, const TArray<FColor>& InMap, const FString& FileName) const;
+	void ExportWeightLayers(const UMapPreset* MapPreset, const FOCGWeightLayerBuffer& InWeightLayers) const;
+	void ErosionPass(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap);
+	void ApplyDropletErosion(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap, const bool bParallel, FRandomStream& SerialStream);
+	void ApplyPipeModelErosion(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap);
+	void StoreErodedHeightMap(const TArray<float>& InHeightMapFloat, const float SeaLevelHeight, TArray<uint16>& InOutHeightMap) const;
+	void SimulateDropletsParallel(const UMapPreset* MapPreset, TArray<float>& InOutHeightMapFloat, const float SeaLevelHeight) const;
+	void SimulateDroplet(const UMapPreset* MapPreset, TArray<float>& InOutHeightMapFloat, const FIntRect& Bounds, float PosX, float PosY, const float SeaLevelHeight) const;
+	void InitializeErosionBrush(const UMapPreset* MapPreset);
+	void ApplyErosionBrush(const UMapPreset* MapPreset, TArray<float>& InOutHeightMapFloat, const int32 NodeX, const int32 NodeY, const float Amount) const;
+	float CalculateHeightAndGradient(const UMapPreset* MapPreset, const TArray<float>& HeightMap, const float LandscapeScale, float PosX, float PosY, FVector2D& OutGradient) const;
+	void ModifyLandscapeWithBiome(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap);
+	// Applies plain smoothing and mountain noise to one row. NoiseScratch must hold MapResolution.X floats
+	void ModifyHeightRow(const UMapPreset* MapPreset, const int32 InY, const bool* InKeepLayerHeight, const float* InBiomeMinHeights, const uint16 SeaLevelHeight, float* NoiseScratch, uint16* InOutHeights) const;
+	void CalculateBiomeMinHeights(const TArray<uint16>& InHeightMap, TArray<float>& OutMinHeights, const UMapPreset* MapPreset);
+	void BlurBiomeMinHeights(TArray<float>& OutMinHeights, const TArray<float>& InMinHeights, const UMapPreset* MapPreset);
+	void GetMaxMinHeight(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap);
+	void SmoothHeightMap(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap);
+	void ApplyGaussianBlur(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap, TArray<uint16>& OutBlurredMap);
+	void ApplySpikeSmooth(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap);
+	void ProcessPlane(const UMapPreset* MapPreset, int32 x, int32 y, const FIntPoint MapSize, const int32 KernelRadius, const int32 KernelSize, const float MaxAllowedSlope, int32& SmoothedRegion, TArray<uint16>& InOriginalHeightMap, TArray<uint16>& OutHeightMap);
+	void FinalizeBiome(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap, const TArray<uint16>& InTempMap, const TArray<uint16>& InHumidityMap, TArray<const FOCGBiomeSettings*>& OutBiomeMap);
+	// Closest biome layer for every quantized (temperature, humidity) pair of the current temperature and humidity range
+	void BuildBiomeLookupTable(const UMapPreset* MapPreset, TArray<uint8>& OutLookupTable) const;
+	void AssignBiomes(const UMapPreset* MapPreset, const TArray<uint16>& InHeightMap, const TArray<uint16>& InTempMap, const TArray<uint16>& InHumidityMap, const uint16 SeaLevelHeight, TArray<const FOCGBiomeSettings*>& OutBiomeMap);
+	void MedianSmooth(const UMapPreset* MapPreset, TArray<uint16>& InOutHeightMap);
+	// Blur buffers taken from the scratch pool, given back with ReleaseBlurScratch
+	FOCGBlurScratch AcquireBlurScratch(int32 NumPixels);
+	void ReleaseBlurScratch(FOCGBlurScratch& Scratch);
+
+	// Private copy of the preset settings, never written after construction
+	TStrongObjectPtr<UMapPreset> Settings;
+	// Stage inputs of the snapshot, and the stage keys of the current run
+	FOCGStageKeys PresetInputHashes;
+	FOCGStageKeys StageKeys;
+	TSharedPtr<FOCGMapStageCache, ESPMode::ThreadSafe> StageCache;
+	bool bUseLayerCache = false;
+	uint64 LayerCacheVersionHash = 0;
+	int64 LayerCacheMaxBytes = 0;
+	// Stages of the current run
+	FOCGGenerationStats StageStats;
+	int32 CurrentStageIndex = 0;
+	int32 CurrentNumStages = 0;
+	int64 CurrentNumPixels = 0;
+
+	FOCGWeightLayerBuffer WeightLayers;
+	TArray<FColor> BiomeColorMap;
+	// Connected biome areas of the last terrain modification by biome
+	FOCGRegionTable BiomeRegions;
+	// Full resolution scratch arrays shared by the stages of one generation run
+	FOCGScratchBufferPool ScratchBuffers;
+
+	float LandscapeZScale = 0.f;
+	float ZOffset = 0.f;
+	float CurMinHeight = 0.f;
+	float CurMaxHeight = 0.f;
+
+	FVector2D PlainNoiseOffset;
+	FVector2D MountainNoiseOffset;
+	FVector2D BlendNoiseOffset;
+	FVector2D DetailNoiseOffset;
+	FVector2D IslandNoiseOffset;
+	float NoiseScale = 1.f;
+	float PlainHeight = 0.f;
+	FRandomStream Stream;
+	// Weight layer index of every pixel, 0 is the water biome
+	TArray<uint8> BiomeIndexMap;
+	// Mountain ratio of every pixel blended with the biome weights
+	TArray<float> MountainRatioMap;
+	// Radial brush shared by every pixel, offsets are relative to the droplet position
+	TArray<FIntPoint> ErosionBrushOffsets;
+	TArray<int32> ErosionBrushIndexOffsets;
+	TArray<float> ErosionBrushWeights;
+	int32 CurrentErosionRadius = 0;
+	int32 ErosionBrushMapWidth = 0;
+
+	float CachedGlobalMinTemp = 0.f;
+	float CachedGlobalMaxTemp = 0.f;
+	float CachedGlobalMinHumidity = 0.f;
+	float CachedGlobalMaxHumidity = 0.f;
+};
@@ -0,0 +1,32 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FOCGMapGenerationResult;
+
+/**
+ * Compressed map generation results on disk, in Saved/OCG/MapCache of the project.
+ *
+ * An entry is keyed by the maps stage key (see OCGStageGraph), the plugin version and the file format version, so it
+ * survives editor restarts and switching presets, and is never read back by a plugin version that may generate
+ * different maps. Entries are written once and replaced as a whole; the least recently used ones are deleted when the
+ * directory grows above the size limit of UOCGDeveloperSettings. Load and Save may run on any thread.
+ */
+namespace OCGMapLayerCache
+{
+	// Hash of the plugin and the file format version. Game thread only
+	ONEBUTTONLEVELGENERATION_API uint64 GetVersionHash();
+	ONEBUTTONLEVELGENERATION_API uint64 MakeKey(uint64 MapsStageKey, uint64 VersionHash);
+
+	// False when there is no valid entry for the key, OutResult is left untouched then.
+	// Resolution and NumWeightLayers bound the sizes read from the file before anything is allocated
+	ONEBUTTONLEVELGENERATION_API bool Load(uint64 Key, const FIntPoint& Resolution, int32 NumWeightLayers, FOCGMapGenerationResult& OutResult);
+	// Writes everything of the result except the stage stats
+	ONEBUTTONLEVELGENERATION_API void Save(uint64 Key, const FOCGMapGenerationResult& Result);
+
+	// Deletes the oldest entries until the directory is below MaxBytes
+	ONEBUTTONLEVELGENERATION_API void Trim(int64 MaxBytes);
+	ONEBUTTONLEVELGENERATION_API FString GetCacheDir();
+}
@@ -25,4 +25,20 @@ public:
 	/** Default PCG Graph for level generation */
 	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Asset References", meta = (AllowClasses = "/Script/PCG.PCGGraph"))
 	TSoftObjectPtr<UPCGGraph> DefaultPCGGraphPath;
+
+	/** Map generation is refused when its estimated peak memory is above this budget. 0 uses the free physical memory as the budget */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Map Generation", meta = (ClampMin = "0", Units = "Megabytes"))
+	int32 MemoryBudgetMB = 0;
+
+	/** Keeps the results of every generation stage and only reruns the stages whose preset properties or upstream stages changed. Costs a copy of the height, temperature and humidity maps */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Map Generation")
+	bool bIncrementalGeneration = true;
+
+	/** Stores the generated maps compressed in Saved/OCG/MapCache and loads them instead of generating again when a preset with the same settings is generated, also after restarting the editor */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Map Generation")
+	bool bMapLayerCache = true;
+
+	/** The least recently used maps are deleted from the map cache when it grows above this size. 0 never deletes */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Map Generation", meta = (ClampMin = "0", Units = "Megabytes", EditCondition = "bMapLayerCache"))
+	int32 MapLayerCacheSizeMB = 2048;
 };
@@ -4,10 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Generator/OCGGenerationStageGraph.h"
 #include "OCGLevelGenerator.generated.h"
 
 class ALandscape;
+class FOCGAsyncMapGeneration;
 struct FOCGBiomeSettings;
+class FOCGWeightLayerBuffer;
 class UOCGLandscapeGenerateComponent;
 class UOCGTerrainGenerateComponent;
 class UOCGMapGenerateComponent;
@@ -29,6 +32,14 @@ public:
 	
 	UFUNCTION(CallInEditor, Category = "Actions")
 	void OnClickGenerate(UWorld* InWorld);
+
+	// Generates the maps on a background task and the landscape, terrain, water and river once they are ready
+	void GenerateAsync(UWorld* InWorld);
+	void CancelMapGeneration();
+	bool IsGeneratingMaps() const;
+	// 0~1 progress and stage name of the running map generation
+	float GetMapGenerationProgress() const;
+	FText GetMapGenerationStageText() const;
 	
 	UOCGMapGenerateComponent* GetMapGenerateComponent() { return MapGenerateComponent; }
 	UOCGTerrainGenerateComponent* GetTerrainGenerateComponent() { return TerrainGenerateComponent; }
@@ -38,7 +49,7 @@ public:
 	const TArray<uint16>& GetHeightMapData() const;
 	const TArray<uint16>& GetTemperatureMapData() const;
 	const TArray<uint16>& GetHumidityMapData() const;
-	const TMap<FName, TArray<uint8>>& GetWeightLayers() const;
+	const FOCGWeightLayerBuffer& GetWeightLayers() const;
 	const ALandscape* GetLandscape() const;
 	ALandscape* GetLandscape();
 	FVector GetVolumeExtent() const;
@@ -55,12 +66,41 @@ public:
 	void DrawDebugLandscape(TArray<uint16>& HeightMapData);
 
 	void PreviewMaps();
+	void PreviewMapsAsync();
+
+	virtual void BeginDestroy() override;
 
 public:
 	UFUNCTION(CallInEditor)
 	void RegenerateOcean();
 	
 private:
+	// Shows an error and returns false when generating maps with the preset would exceed the memory budget
+	bool CheckMemoryBudget() const;
+	// Shows an error and returns false when the preset can not be used to generate maps
+	bool CanGenerateMaps() const;
+	// Reads the height map file of the preset if it has one, false when reading failed
+	bool ImportHeightMap(bool& bOutHasHeightMap);
+	// Landscape, terrain, water and river from the maps of the preset, skipping the stages whose inputs did not change
+	void GenerateLevelFromMaps(UWorld* InWorld, const FOCGStageKeys& Keys);
+	void LaunchMapGeneration(bool bHasHeightMap, TFunction<void(const FOCGStageKeys&)>&& OnMapsReady);
+
+	// Stage keys of the preset in its current state
+	FOCGStageKeys ComputeStageKeys() const;
+	// True when incremental generation is on and the stage last ran with the same key
+	bool IsStageUpToDate(const FOCGStageKeys& Keys, EOCGGenerationStage Stage) const;
+	bool AreMapsUpToDate(const FOCGStageKeys& Keys) const;
+	void MarkMapsGenerated(const FOCGStageKeys& Keys);
+
+	TSharedPtr<FOCGAsyncMapGeneration> MapGenerationJob;
+	// Keys of the stages as they last ran for this level generator
+	FOCGStageKeys LastStageKeys;
+	// Hash of the imported height map, 0 when the maps are generated from noise
+	uint64 ImportedHeightMapKey = 0;
+	// Whether the last map generation wrote the map textures
+	bool bLastMapsExported = false;
+
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LevelGenerator", meta = (AllowPrivateAccess = "true"))
 	TObjectPtr<UMapPreset> MapPreset;
 
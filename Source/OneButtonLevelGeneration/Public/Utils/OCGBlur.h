@@ -0,0 +1,312 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Utils/OCGParallelUtils.h"
+
+#include <type_traits>
+
+// How samples outside of the map are treated
+enum class EOCGBlurEdgeMode : uint8
+{
+	// Repeat the closest edge pixel
+	Clamp,
+	// Samples outside of the map are 0
+	Zero,
+};
+
+// Intermediate float maps of a blur. Callers that blur repeatedly pass the same buffers instead of allocating them per blur
+struct FOCGBlurScratch
+{
+	// Both hold at least Width * Height floats
+	TArray<float> Horizontal;
+	TArray<float> Transposed;
+};
+
+/**
+ * Separable blurs for uint8 / uint16 / float maps.
+ * Rows are filtered in parallel bands. Columns are filtered by transposing the map in cache sized blocks, filtering the
+ * transposed rows and transposing back, so both passes read memory in order.
+ * Intermediate values are float, integer outputs are rounded and clamped. In and Out may point to the same buffer.
+ * Without a Scratch the blur allocates two full resolution float maps for its duration.
+ */
+namespace OCGBlur
+{
+	namespace Private
+	{
+		// Pixels per side of a transpose block, 64 x 64 floats fit L1 together with the destination block
+		constexpr int32 TransposeBlockSize = 64;
+
+		template <typename T>
+		FORCEINLINE float ToFloat(const T Value)
+		{
+			return static_cast<float>(Value);
+		}
+
+		template <typename T>
+		FORCEINLINE T FromFloat(const float Value)
+		{
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				return static_cast<T>(Value);
+			}
+			else
+			{
+				return static_cast<T>(FMath::Clamp<int32>(FMath::RoundToInt(Value), TNumericLimits<T>::Min(), TNumericLimits<T>::Max()));
+			}
+		}
+
+		FORCEINLINE float SampleRow(const float* Src, const int32 Length, const int32 Index, const EOCGBlurEdgeMode EdgeMode)
+		{
+			if (Index >= 0 && Index < Length)
+				return Src[Index];
+			return EdgeMode == EOCGBlurEdgeMode::Clamp ? Src[FMath::Clamp(Index, 0, Length - 1)] : 0.f;
+		}
+
+		// Running sum box filter, cost does not depend on the radius. Src and Dst must not overlap
+		inline void BoxFilterRow(const float* Src, float* Dst, const int32 Length, const int32 Radius, const EOCGBlurEdgeMode EdgeMode)
+		{
+			// Sum in double so long rows do not accumulate rounding drift
+			const double Scale = 1.0 / (2 * Radius + 1);
+			double Sum = 0.0;
+			for (int32 i = -Radius; i <= Radius; ++i)
+			{
+				Sum += SampleRow(Src, Length, i, EdgeMode);
+			}
+			Dst[0] = static_cast<float>(Sum * Scale);
+
+			for (int32 x = 1; x < Length; ++x)
+			{
+				Sum += SampleRow(Src, Length, x + Radius, EdgeMode) - SampleRow(Src, Length, x - Radius - 1, EdgeMode);
+				Dst[x] = static_cast<float>(Sum * Scale);
+			}
+		}
+
+		// Convolution with a symmetric kernel of 2 * Radius + 1 weights. Src and Dst must not overlap
+		inline void KernelFilterRow(const float* Src, float* Dst, const int32 Length, const TArray<float>& Kernel, const EOCGBlurEdgeMode EdgeMode)
+		{
+			const int32 Radius = Kernel.Num() / 2;
+			const float* Weights = Kernel.GetData() + Radius;
+
+			for (int32 x = 0; x < Length; ++x)
+			{
+				float Sum = 0.f;
+				if (x >= Radius && x + Radius < Length)
+				{
+					const float* Center = Src + x;
+					for (int32 i = -Radius; i <= Radius; ++i)
+					{
+						Sum += Center[i] * Weights[i];
+					}
+				}
+				else
+				{
+					for (int32 i = -Radius; i <= Radius; ++i)
+					{
+						Sum += SampleRow(Src, Length, x + i, EdgeMode) * Weights[i];
+					}
+				}
+				Dst[x] = Sum;
+			}
+		}
+
+		// Dst is SrcHeight wide and SrcWidth tall
+		template <typename SrcType, typename DstType>
+		void TransposeBlocked(const SrcType* Src, DstType* Dst, const int32 SrcWidth, const int32 SrcHeight, const int32 MaxThreads)
+		{
+			const int32 NumBlockRows = FMath::DivideAndRoundUp(SrcHeight, TransposeBlockSize);
+			FOCGParallelUtils::ParallelForEach(NumBlockRows, MaxThreads, [&](const int32 BlockRow)
+			{
+				const int32 StartY = BlockRow * TransposeBlockSize;
+				const int32 EndY = FMath::Min(StartY + TransposeBlockSize, SrcHeight);
+				for (int32 StartX = 0; StartX < SrcWidth; StartX += TransposeBlockSize)
+				{
+					const int32 EndX = FMath::Min(StartX + TransposeBlockSize, SrcWidth);
+					for (int32 y = StartY; y < EndY; ++y)
+					{
+						const SrcType* SrcRow = Src + static_cast<int64>(y) * SrcWidth;
+						for (int32 x = StartX; x < EndX; ++x)
+						{
+							Dst[static_cast<int64>(x) * SrcHeight + y] = FromFloat<DstType>(ToFloat(SrcRow[x]));
+						}
+					}
+				}
+			});
+		}
+
+		// Runs RowFilter(Src, Dst, Length) along every row and then every column
+		template <typename InType, typename OutType, typename RowFilterType>
+		void SeparableBlur(const InType* In, OutType* Out, const int32 Width, const int32 Height, const int32 MaxThreads, FOCGBlurScratch* Scratch,
+			const RowFilterType& RowFilter)
+		{
+			const int32 NumPixels = Width * Height;
+			FOCGBlurScratch LocalScratch;
+			if (!Scratch)
+			{
+				LocalScratch.Horizontal.SetNumUninitialized(NumPixels);
+				LocalScratch.Transposed.SetNumUninitialized(NumPixels);
+				Scratch = &LocalScratch;
+			}
+			check(Scratch->Horizontal.Num() >= NumPixels && Scratch->Transposed.Num() >= NumPixels);
+			TArray<float>& Horizontal = Scratch->Horizontal;
+			TArray<float>& Transposed = Scratch->Transposed;
+
+			// 1. Rows
+			FOCGParallelUtils::ParallelForRows(Height, MaxThreads, [&](const int32 StartY, const int32 EndY)
+			{
+				TArray<float> Source;
+				Source.SetNumUninitialized(Width);
+				for (int32 y = StartY; y < EndY; ++y)
+				{
+					const InType* InRow = In + static_cast<int64>(y) * Width;
+					for (int32 x = 0; x < Width; ++x)
+					{
+						Source[x] = ToFloat(InRow[x]);
+					}
+					RowFilter(Source.GetData(), Horizontal.GetData() + static_cast<int64>(y) * Width, Width);
+				}
+			});
+
+			// 2. Columns, as rows of the transposed map
+			TransposeBlocked(Horizontal.GetData(), Transposed.GetData(), Width, Height, MaxThreads);
+			FOCGParallelUtils::ParallelForRows(Width, MaxThreads, [&](const int32 StartX, const int32 EndX)
+			{
+				TArray<float> Source;
+				Source.SetNumUninitialized(Height);
+				for (int32 x = StartX; x < EndX; ++x)
+				{
+					float* Column = Transposed.GetData() + static_cast<int64>(x) * Height;
+					FMemory::Memcpy(Source.GetData(), Column, Height * sizeof(float));
+					RowFilter(Source.GetData(), Column, Height);
+				}
+			});
+			TransposeBlocked(Transposed.GetData(), Out, Height, Width, MaxThreads);
+		}
+
+		// Most box passes used for a Gaussian approximation, more passes follow the Gaussian closer at linear cost
+		constexpr int32 MaxGaussianBoxPasses = 4;
+
+		// Box passes for Sigma: as many as keep every box at least 3 pixels wide (12 * Sigma^2 / Passes + 1 >= 9),
+		// narrower boxes stop smoothing and only add passes
+		inline int32 GetGaussianBoxPassCount(const float Sigma)
+		{
+			return FMath::Clamp(FMath::FloorToInt(1.5f * Sigma * Sigma), 1, MaxGaussianBoxPasses);
+		}
+
+		// Radii of NumPasses box filters whose repeated application approximates a Gaussian of Sigma (Kovesi)
+		inline void GetGaussianBoxRadii(const float Sigma, const int32 NumPasses, TArray<int32, TInlineAllocator<MaxGaussianBoxPasses>>& OutRadii)
+		{
+			const float IdealWidth = FMath::Sqrt(12.f * Sigma * Sigma / NumPasses + 1.f);
+			int32 LowerWidth = FMath::FloorToInt(IdealWidth);
+			if (LowerWidth % 2 == 0)
+			{
+				--LowerWidth;
+			}
+			const float IdealLowerCount = (12.f * Sigma * Sigma - NumPasses * LowerWidth * LowerWidth - 4.f * NumPasses * LowerWidth - 3.f * NumPasses) / (-4.f * LowerWidth - 4.f);
+			const int32 LowerCount = FMath::RoundToInt(IdealLowerCount);
+
+			OutRadii.SetNum(NumPasses);
+			for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+			{
+				const int32 BoxWidth = Pass < LowerCount ? LowerWidth : LowerWidth + 2;
+				OutRadii[Pass] = FMath::Max((BoxWidth - 1) / 2, 0);
+			}
+		}
+
+		template <typename InType, typename OutType>
+		void CopyConverted(const InType* In, OutType* Out, const int64 NumPixels)
+		{
+			if (static_cast<const void*>(In) == static_cast<const void*>(Out))
+				return;
+			for (int64 i = 0; i < NumPixels; ++i)
+			{
+				Out[i] = FromFloat<OutType>(ToFloat(In[i]));
+			}
+		}
+	}
+
+	// Average of the (2 * Radius + 1)^2 window around every pixel
+	template <typename InType, typename OutType>
+	void BoxBlur(const InType* In, OutType* Out, const int32 Width, const int32 Height, const int32 Radius, const EOCGBlurEdgeMode EdgeMode, const int32 MaxThreads = 0,
+		FOCGBlurScratch* Scratch = nullptr)
+	{
+		if (Width <= 0 || Height <= 0)
+			return;
+		if (Radius <= 0)
+		{
+			Private::CopyConverted(In, Out, static_cast<int64>(Width) * Height);
+			return;
+		}
+
+		Private::SeparableBlur(In, Out, Width, Height, MaxThreads, Scratch, [Radius, EdgeMode](const float* Src, float* Dst, const int32 Length)
+		{
+			Private::BoxFilterRow(Src, Dst, Length, Radius, EdgeMode);
+		});
+	}
+
+	// Gaussian of the given Sigma truncated to Radius, weights are computed once and normalized
+	template <typename InType, typename OutType>
+	void GaussianBlur(const InType* In, OutType* Out, const int32 Width, const int32 Height, const int32 Radius, const float Sigma, const EOCGBlurEdgeMode EdgeMode,
+		const int32 MaxThreads = 0, FOCGBlurScratch* Scratch = nullptr)
+	{
+		if (Width <= 0 || Height <= 0)
+			return;
+		if (Radius <= 0 || Sigma <= 0.f)
+		{
+			Private::CopyConverted(In, Out, static_cast<int64>(Width) * Height);
+			return;
+		}
+
+		TArray<float> Kernel;
+		Kernel.SetNumUninitialized(2 * Radius + 1);
+		float WeightSum = 0.f;
+		for (int32 i = -Radius; i <= Radius; ++i)
+		{
+			Kernel[i + Radius] = FMath::Exp(-(i * i) / (2.f * Sigma * Sigma));
+			WeightSum += Kernel[i + Radius];
+		}
+		for (float& Weight : Kernel)
+		{
+			Weight /= WeightSum;
+		}
+
+		Private::SeparableBlur(In, Out, Width, Height, MaxThreads, Scratch, [&Kernel, EdgeMode](const float* Src, float* Dst, const int32 Length)
+		{
+			Private::KernelFilterRow(Src, Dst, Length, Kernel, EdgeMode);
+		});
+	}
+
+	// Approximates a Gaussian of Sigma with running sum box filters, the pass count follows from Sigma. Cost does not
+	// depend on Sigma, which makes it the better choice for radii where the GaussianBlur kernel gets long
+	template <typename InType, typename OutType>
+	void ApproximateGaussianBlur(const InType* In, OutType* Out, const int32 Width, const int32 Height, const float Sigma, const EOCGBlurEdgeMode EdgeMode,
+		const int32 MaxThreads = 0, FOCGBlurScratch* Scratch = nullptr)
+	{
+		if (Width <= 0 || Height <= 0)
+			return;
+		if (Sigma <= 0.f)
+		{
+			Private::CopyConverted(In, Out, static_cast<int64>(Width) * Height);
+			return;
+		}
+
+		TArray<int32, TInlineAllocator<Private::MaxGaussianBoxPasses>> Radii;
+		Private::GetGaussianBoxRadii(Sigma, Private::GetGaussianBoxPassCount(Sigma), Radii);
+
+		Private::SeparableBlur(In, Out, Width, Height, MaxThreads, Scratch, [&Radii, EdgeMode](const float* Src, float* Dst, const int32 Length)
+		{
+			// Box passes of one axis are applied back to back, ping-ponging between Dst and a local copy
+			TArray<float, TInlineAllocator<1024>> Buffer;
+			Buffer.SetNumUninitialized(Length);
+			const float* PassSource = Src;
+			for (int32 Pass = 0; Pass < Radii.Num(); ++Pass)
+			{
+				// The last pass must end in Dst
+				float* PassTarget = ((Radii.Num() - 1 - Pass) % 2 == 0) ? Dst : Buffer.GetData();
+				Private::BoxFilterRow(PassSource, PassTarget, Length, Radii[Pass], EdgeMode);
+				PassSource = PassTarget;
+			}
+		});
+	}
+}
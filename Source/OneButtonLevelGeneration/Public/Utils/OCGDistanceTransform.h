@@ -0,0 +1,17 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Exact Euclidean distance transform (Felzenszwalb & Huttenlocher).
+ * Runs a vertical pass over column bands and a lower envelope of parabolas over rows, both in parallel.
+ * Cost is linear in the number of pixels.
+ */
+namespace OCGDistanceTransform
+{
+	// Writes the distance in pixels from every pixel to the nearest seed pixel.
+	// When the map has no seed every distance is TNumericLimits<float>::Max()
+	ONEBUTTONLEVELGENERATION_API void EuclideanDistance(const TArray<bool>& InSeeds, int32 Width, int32 Height, int32 MaxThreads, TArray<float>& OutDistances);
+}
@@ -0,0 +1,39 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * D8 drainage of a height field towards its sea pixels.
+ *
+ * A priority flood (Barnes et al. 2014, with a FIFO queue for depressions) grows from the coast inland in order of
+ * spill height and points every land pixel at the pixel it was reached from. Depressions and flats drain towards
+ * their spill point without modifying the heights. The closing order of the flood is a topological order of the
+ * drainage tree, so the flow accumulation is a single reverse sweep.
+ */
+class ONEBUTTONLEVELGENERATION_API FOCGDrainageNetwork
+{
+public:
+	// Pixels whose height is below SeaHeight are outlets. Without any outlet the network stays empty
+	void Build(const TArray<float>& InHeights, const FIntPoint& InResolution, float SeaHeight);
+
+	/**
+	 * Channels in order of drained area. A channel is traced from its mouth upstream along the donor with the largest
+	 * area and ends where the drained area falls below MinAccumulation. The first channels flow into the sea, later
+	 * ones may be tributaries ending on a pixel of an earlier channel.
+	 * Every path runs from the source down to and including the pixel it flows into.
+	 */
+	void ExtractChannels(int32 NumChannels, int32 MinAccumulation, int32 MinLength, TArray<TArray<FIntPoint>>& OutChannels) const;
+
+	FORCEINLINE bool IsEmpty() const { return Receivers.IsEmpty(); }
+	// Pixel the water of a pixel flows to, INDEX_NONE for sea pixels
+	FORCEINLINE const TArray<int32>& GetReceivers() const { return Receivers; }
+	// Number of land pixels draining through every pixel, the pixel included
+	FORCEINLINE const TArray<int32>& GetAccumulation() const { return Accumulation; }
+
+private:
+	FIntPoint Resolution = FIntPoint::ZeroValue;
+	TArray<int32> Receivers;
+	TArray<int32> Accumulation;
+};
@@ -0,0 +1,38 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Pixels of a 16 bit height map sorted by height, built with one counting sort pass.
+ *
+ * Every height value owns a bucket of the sorted pixel array, so the pixels at or above any height are a suffix that is
+ * found with one lookup. Sampling above a threshold then costs O(attempts) instead of a scan over the whole map.
+ */
+class ONEBUTTONLEVELGENERATION_API FOCGElevationIndex
+{
+public:
+	void Build(const TArray<uint16>& InHeightMap, const FIntPoint& InResolution);
+	void Reset();
+
+	// Indices of every pixel whose height is at least MinHeight, lowest first
+	TConstArrayView<int32> GetPixelsAtOrAbove(uint16 MinHeight) const;
+
+	/**
+	 * Random pixel at or above MinHeight that keeps MinSpacing pixels away from every point in Taken.
+	 * Tries up to MaxAttempts candidates and falls back to the one farthest from Taken when none keeps the spacing.
+	 * False when no pixel reaches MinHeight.
+	 */
+	bool SampleAtOrAbove(uint16 MinHeight, FRandomStream& Stream, float MinSpacing, TConstArrayView<FIntPoint> Taken,
+		int32 MaxAttempts, FIntPoint& OutPoint) const;
+
+	FORCEINLINE bool IsEmpty() const { return SortedPixels.IsEmpty(); }
+	FORCEINLINE const FIntPoint& GetResolution() const { return Resolution; }
+
+private:
+	FIntPoint Resolution = FIntPoint::ZeroValue;
+	// First entry of SortedPixels for every height value, the last entry is the number of pixels
+	TArray<int32> BucketStarts;
+	TArray<int32> SortedPixels;
+};
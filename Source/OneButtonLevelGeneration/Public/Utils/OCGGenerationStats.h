@@ -0,0 +1,109 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+class FOCGScratchBufferPool;
+
+// Time and memory of one generation stage
+struct FOCGStageStats
+{
+	FString StageName;
+	double Milliseconds = 0.0;
+	// Pixels the stage worked on, 0 when the stage is not per pixel
+	int64 NumPixels = 0;
+	// Highest scratch pool usage while the stage ran
+	int64 ScratchPeakBytes = 0;
+	// Change of the process' used physical memory over the stage, persistent maps show up here
+	int64 UsedPhysicalDelta = 0;
+	// Peak used physical memory of the process when the stage ended
+	uint64 PeakUsedPhysical = 0;
+};
+
+/**
+ * Collects the stages of one generation run (maps, landscape, terrain, river) and writes them as a table to the log
+ * and to a CSV file in Saved/OCG/Stats when the outermost run ends.
+ * Get() records the stages of the editor on the game thread, one run at a time. Generators that run on worker
+ * threads keep their own instance and hand the finished stages to Get() with AddStage.
+ */
+class ONEBUTTONLEVELGENERATION_API FOCGGenerationStats
+{
+public:
+	static FOCGGenerationStats& Get();
+
+	// Runs nest, only the outermost run resets the table and reports it
+	void BeginRun();
+	void EndRun(const TCHAR* RunName);
+
+	void BeginStage(FOCGScratchBufferPool* Pool);
+	void EndStage(const TCHAR* StageName, int64 NumPixels, const FOCGScratchBufferPool* Pool);
+
+	// Adds a stage that was measured by another instance
+	void AddStage(const FOCGStageStats& Stage);
+	// Forgets every stage without reporting them
+	void ResetStages();
+
+	FORCEINLINE const TArray<FOCGStageStats>& GetStages() const { return Stages; }
+
+private:
+	void LogSummary(const TCHAR* RunName) const;
+	void WriteCsv(const TCHAR* RunName) const;
+
+	TArray<FOCGStageStats> Stages;
+	int32 RunDepth = 0;
+
+	// Start of the innermost open stage
+	struct FOpenStage
+	{
+		double StartTime = 0.0;
+		uint64 StartUsedPhysical = 0;
+	};
+	TArray<FOpenStage> OpenStages;
+};
+
+// Records a stage from construction to destruction
+class ONEBUTTONLEVELGENERATION_API FOCGScopedGenerationStage
+{
+public:
+	FOCGScopedGenerationStage(const TCHAR* InStageName, const int64 InNumPixels = 0, FOCGScratchBufferPool* InPool = nullptr)
+		: StageName(InStageName), NumPixels(InNumPixels), Pool(InPool)
+	{
+		FOCGGenerationStats::Get().BeginStage(Pool);
+	}
+
+	~FOCGScopedGenerationStage()
+	{
+		FOCGGenerationStats::Get().EndStage(StageName, NumPixels, Pool);
+	}
+
+private:
+	const TCHAR* StageName;
+	int64 NumPixels;
+	FOCGScratchBufferPool* Pool;
+};
+
+// Reports the stages recorded until the end of the scope as one run
+class FOCGScopedGenerationRun
+{
+public:
+	explicit FOCGScopedGenerationRun(const TCHAR* InRunName)
+		: RunName(InRunName)
+	{
+		FOCGGenerationStats::Get().BeginRun();
+	}
+
+	~FOCGScopedGenerationRun()
+	{
+		FOCGGenerationStats::Get().EndRun(RunName);
+	}
+
+private:
+	const TCHAR* RunName;
+};
+
+// Named Unreal Insights scope plus a row in the generation stats table
+#define OCG_SCOPED_GENERATION_STAGE(StageName, NumPixels) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(StageName); \
+	FOCGScopedGenerationStage PREPROCESSOR_JOIN(OCGGenerationStage, __LINE__)(StageName, NumPixels)
@@ -0,0 +1,35 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Parameters of the grid based (virtual pipe) hydraulic erosion
+struct FOCGPipeErosionSettings
+{
+	int32 Iterations = 100;
+	float TimeStep = 0.05f;
+	// Water added to every cell per iteration, same unit as heights
+	float RainAmount = 1.f;
+	// Sediment a unit of flowing water can carry
+	float SedimentCapacity = 1.f;
+	float DissolveRate = 0.3f;
+	float DepositRate = 0.3f;
+	float EvaporationRate = 0.5f;
+	// Horizontal distance between two cells, same unit as heights
+	float CellSize = 100.f;
+	// Cells at or below this height drain their water and sediment into the sea
+	float SeaLevelHeight = TNumericLimits<float>::Lowest();
+	// Maximum number of threads, 0 means no limit
+	int32 MaxThreads = 0;
+};
+
+/**
+ * Grid based hydraulic erosion (virtual pipe model, Mei et al. 2007).
+ * Every cell stores water, outflow flux to its 4 neighbours and suspended sediment. All cells are updated
+ * in lock step passes, so the cost is Iterations x pixels and the result does not depend on thread count.
+ */
+namespace OCGHydraulicErosion
+{
+	ONEBUTTONLEVELGENERATION_API void ErodePipeModel(const FOCGPipeErosionSettings& Settings, int32 Width, int32 Height, TArray<float>& InOutHeights);
+}
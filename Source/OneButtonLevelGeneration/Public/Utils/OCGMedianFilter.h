@@ -0,0 +1,17 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Median filter for 16 bit maps using a two level (coarse 256 / fine 65536 bin) sliding histogram.
+ * Moving the window one pixel updates the histogram with 2 * (2R + 1) pixels and the median is found by scanning
+ * at most 256 coarse and 256 fine bins, so the cost per pixel grows linearly with the radius instead of R^2 log R.
+ */
+namespace OCGMedianFilter
+{
+	// Writes the median of the (2 * Radius + 1)^2 window of every pixel at least Radius pixels away from the map border.
+	// Border pixels keep their input value. Rows are processed in parallel bands
+	ONEBUTTONLEVELGENERATION_API void MedianFilter(const TArray<uint16>& InMap, TArray<uint16>& OutMap, int32 Width, int32 Height, int32 Radius, int32 MaxThreads);
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+#include <type_traits>
+
+// Allocations made while generating maps, visible in the LLM report when the editor runs with -llm
+LLM_DECLARE_TAG_API(OCGMapGeneration, ONEBUTTONLEVELGENERATION_API);
+
+/**
+ * Keeps full resolution scratch arrays between generation stages, so a stage reuses the memory released by the
+ * previous one instead of allocating it again. Buffers are handed out by value and must be given back with Release.
+ * Not thread safe, acquire and release buffers on the thread that runs the stages.
+ */
+class ONEBUTTONLEVELGENERATION_API FOCGScratchBufferPool
+{
+public:
+	// Returns a buffer of Num elements with undefined content. The smallest pooled buffer that is large enough is reused
+	template <typename T>
+	TArray<T> Acquire(const int32 Num)
+	{
+		LLM_SCOPE_BYTAG(OCGMapGeneration);
+
+		TArray<TArray<T>>& FreeBuffers = GetFreeBuffers<T>();
+		int32 BestIndex = INDEX_NONE;
+		for (int32 Index = 0; Index < FreeBuffers.Num(); ++Index)
+		{
+			const int32 Capacity = FreeBuffers[Index].Max();
+			if (Capacity >= Num && (BestIndex == INDEX_NONE || Capacity < FreeBuffers[BestIndex].Max()))
+			{
+				BestIndex = Index;
+			}
+		}
+
+		TArray<T> Buffer;
+		if (BestIndex != INDEX_NONE)
+		{
+			Buffer = MoveTemp(FreeBuffers[BestIndex]);
+			FreeBuffers.RemoveAtSwap(BestIndex);
+			PooledBytes -= Buffer.GetAllocatedSize();
+		}
+		Buffer.SetNumUninitialized(Num, EAllowShrinking::No);
+
+		LiveBytes += Buffer.GetAllocatedSize();
+		PeakBytes = FMath::Max(PeakBytes, LiveBytes + PooledBytes);
+		return Buffer;
+	}
+
+	// Gives a buffer back to the pool, Buffer is empty afterwards
+	template <typename T>
+	void Release(TArray<T>& Buffer)
+	{
+		if (Buffer.Max() == 0)
+			return;
+
+		const int64 BufferBytes = Buffer.GetAllocatedSize();
+		LiveBytes = FMath::Max<int64>(LiveBytes - BufferBytes, 0);
+		PooledBytes += BufferBytes;
+		GetFreeBuffers<T>().Add(MoveTemp(Buffer));
+		Buffer.Reset();
+	}
+
+	// Frees every pooled buffer
+	void Empty();
+
+	// Bytes of buffers currently handed out
+	FORCEINLINE int64 GetLiveBytes() const { return LiveBytes; }
+	// Bytes kept for reuse
+	FORCEINLINE int64 GetPooledBytes() const { return PooledBytes; }
+	// Highest live + pooled bytes since the last ResetPeak
+	FORCEINLINE int64 GetPeakBytes() const { return PeakBytes; }
+	FORCEINLINE void ResetPeak() { PeakBytes = LiveBytes + PooledBytes; }
+
+private:
+	template <typename T>
+	TArray<TArray<T>>& GetFreeBuffers()
+	{
+		if constexpr (std::is_same_v<T, float>)
+		{
+			return FreeFloatBuffers;
+		}
+		else
+		{
+			static_assert(std::is_same_v<T, uint16>, "Scratch buffers are float or uint16");
+			return FreeUInt16Buffers;
+		}
+	}
+
+	TArray<TArray<float>> FreeFloatBuffers;
+	TArray<TArray<uint16>> FreeUInt16Buffers;
+	int64 LiveBytes = 0;
+	int64 PooledBytes = 0;
+	int64 PeakBytes = 0;
+};
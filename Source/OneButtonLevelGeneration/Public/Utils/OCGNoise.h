@@ -0,0 +1,36 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Settings of a fractal (fBm) noise made of several Perlin octaves
+struct FOCGFractalNoiseSettings
+{
+	// Added to every sample position after scaling
+	FVector2f Offset = FVector2f::ZeroVector;
+	// Frequency of the first octave
+	float Scale = 1.f;
+	int32 Octaves = 1;
+	// Amplitude multiplier between octaves
+	float Persistence = 0.5f;
+	// Frequency multiplier between octaves
+	float Lacunarity = 2.f;
+};
+
+/**
+ * 2D gradient noise used by map generation.
+ * Row functions evaluate 4 samples per call with VectorRegister (SSE / NEON) and fall back to the scalar path
+ * on platforms without vector intrinsics. Both paths give the same result for the same position.
+ */
+namespace OCGNoise
+{
+	// Returns noise in -1~1 range
+	ONEBUTTONLEVELGENERATION_API float Perlin2D(float X, float Y);
+
+	// Samples Perlin2D at ((StartX + i) * Scale + Offset.X, Y * Scale + Offset.Y) for i in [0, Count)
+	ONEBUTTONLEVELGENERATION_API void PerlinRow(const FVector2f& Offset, float Scale, int32 StartX, int32 Y, int32 Count, float* OutValues);
+
+	// Samples every octave of a fractal noise along a row. Result is normalized to -1~1 range
+	ONEBUTTONLEVELGENERATION_API void FractalRow(const FOCGFractalNoiseSettings& Settings, int32 StartX, int32 Y, int32 Count, float* OutValues);
+}
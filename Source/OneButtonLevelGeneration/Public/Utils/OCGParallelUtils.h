@@ -0,0 +1,54 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+
+struct FOCGParallelUtils
+{
+public:
+	// Number of threads a parallel job may use. MaxThreads <= 0 means every available worker
+	static int32 GetNumWorkers(const int32 MaxThreads)
+	{
+		// The calling thread helps with ParallelFor work as well
+		const int32 AvailableWorkers = FTaskGraphInterface::IsRunning() ? FTaskGraphInterface::Get().GetNumWorkerThreads() + 1 : 1;
+		return MaxThreads > 0 ? FMath::Min(MaxThreads, AvailableWorkers) : AvailableWorkers;
+	}
+
+	// Splits [0, NumRows) into contiguous bands and calls Body(StartRow, EndRow) for every band in parallel.
+	// No more than MaxThreads bands run at the same time (MaxThreads <= 0 means no limit)
+	static void ParallelForRows(const int32 NumRows, const int32 MaxThreads, TFunctionRef<void(int32, int32)> Body)
+	{
+		if (NumRows <= 0)
+			return;
+
+		const int32 NumWorkers = GetNumWorkers(MaxThreads);
+		// Several bands per worker balances rows of uneven cost, a capped job uses exactly one band per allowed thread
+		const int32 NumBands = FMath::Clamp(MaxThreads > 0 ? NumWorkers : NumWorkers * 4, 1, NumRows);
+		const int32 RowsPerBand = FMath::DivideAndRoundUp(NumRows, NumBands);
+
+		ParallelFor(NumBands, [&](const int32 BandIndex)
+		{
+			const int32 StartRow = BandIndex * RowsPerBand;
+			const int32 EndRow = FMath::Min(StartRow + RowsPerBand, NumRows);
+			if (StartRow < EndRow)
+			{
+				Body(StartRow, EndRow);
+			}
+		}, NumBands == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	}
+
+	// Calls Body(Index) for every index in [0, Num) in parallel, no more than MaxThreads at the same time
+	static void ParallelForEach(const int32 Num, const int32 MaxThreads, TFunctionRef<void(int32)> Body)
+	{
+		ParallelForRows(Num, MaxThreads, [&Body](const int32 Start, const int32 End)
+		{
+			for (int32 Index = Start; Index < End; ++Index)
+			{
+				Body(Index);
+			}
+		});
+	}
+};
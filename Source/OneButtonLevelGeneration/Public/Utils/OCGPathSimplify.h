@@ -0,0 +1,26 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Polyline simplification over index ranges of the original points.
+ *
+ * Both methods only mark the points to keep in a bit array over the input, nothing is copied until the kept points are
+ * gathered once at the end. The first and the last point are always kept.
+ */
+namespace OCGPathSimplify
+{
+	// Ramer-Douglas-Peucker with an explicit stack of index ranges. Keeps points farther than Epsilon from the simplified line
+	ONEBUTTONLEVELGENERATION_API void RamerDouglasPeucker(TConstArrayView<FVector> Points, float Epsilon, TBitArray<>& OutKeep);
+
+	/**
+	 * Visvalingam-Whyatt. Repeatedly drops the point spanning the smallest triangle with its neighbors until every
+	 * remaining triangle has at least MinArea. Areas of the neighbors of a dropped point never fall below the dropped
+	 * area, so the removal order stays monotonic.
+	 */
+	ONEBUTTONLEVELGENERATION_API void Visvalingam(TConstArrayView<FVector> Points, float MinArea, TBitArray<>& OutKeep);
+
+	ONEBUTTONLEVELGENERATION_API void GatherKept(TConstArrayView<FVector> Points, const TBitArray<>& Keep, TArray<FVector>& OutPoints);
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Statistics of one 4-connected region of pixels sharing the same class. Heights are height map values
+struct FOCGRegion
+{
+	uint8 Class = 0;
+	int32 Area = 0;
+	uint16 MinHeight = MAX_uint16;
+	uint16 MaxHeight = 0;
+	float MeanHeight = 0.f;
+	// Inclusive min, exclusive max pixel coordinates
+	FIntRect Bounds = FIntRect(MAX_int32, MAX_int32, MIN_int32, MIN_int32);
+};
+
+/**
+ * Connected component labeling of a class map (e.g. biome layer index per pixel).
+ * Row bands are labeled in parallel with union-find, band borders are merged afterwards and a single flattening pass
+ * assigns compact region indices. Everything runs in O(pixels) without hashing.
+ */
+class ONEBUTTONLEVELGENERATION_API FOCGRegionTable
+{
+public:
+	void Build(const TArray<uint8>& InClassMap, const TArray<uint16>& InHeightMap, const FIntPoint& InResolution, int32 MaxThreads);
+	void Empty();
+	// Reads or writes the labels and regions, used by the map layer cache
+	void Serialize(FArchive& Ar);
+
+	FORCEINLINE const FIntPoint& GetResolution() const { return Resolution; }
+	// Region index of every pixel
+	FORCEINLINE const TArray<int32>& GetRegionMap() const { return RegionMap; }
+	FORCEINLINE const TArray<FOCGRegion>& GetRegions() const { return Regions; }
+	FORCEINLINE const FOCGRegion& GetRegionOfPixel(const int32 PixelIndex) const { return Regions[RegionMap[PixelIndex]]; }
+
+private:
+	TArray<int32> RegionMap;
+	TArray<FOCGRegion> Regions;
+	FIntPoint Resolution = FIntPoint::ZeroValue;
+};
@@ -0,0 +1,66 @@
+// Copyright (c) 2025 Code1133. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Per-pixel data shared by every river search on one map: world heights, the sea mask that ends a search and the
+ * distance to the sea used as the A* heuristic. Read only once built, so searches may share it.
+ *
+ * Moving to a neighbor costs its length in pixels (1 or sqrt 2) plus a penalty for climbing. Every step costs at least
+ * its length, so the Euclidean distance to the nearest sea pixel is an admissible and consistent heuristic.
+ */
+struct ONEBUTTONLEVELGENERATION_API FOCGRiverCostField
+{
+	// InHeights are world heights of every pixel, PixelSize the world distance between two neighboring pixels
+	void Build(TArray<float>&& InHeights, const FIntPoint& InResolution, float InSeaHeight, float InPixelSize, int32 MaxThreads);
+
+	FORCEINLINE bool IsSea(const int32 Index) const { return Heights[Index] < SeaHeight; }
+	FORCEINLINE bool HasSea() const { return bHasSea; }
+	FORCEINLINE int32 Num() const { return Heights.Num(); }
+
+	FIntPoint Resolution = FIntPoint::ZeroValue;
+	TArray<float> Heights;
+	// Distance in pixels to the nearest sea pixel
+	TArray<float> SeaDistance;
+	float SeaHeight = 0.f;
+	// Cost of climbing one pixel size of height, in pixels of flat travel
+	float UphillCostScale = 0.f;
+	bool bHasSea = false;
+};
+
+/**
+ * A* from a source pixel to the nearest sea pixel of a FOCGRiverCostField, 8-connected.
+ *
+ * The open list is a binary heap with lazy deletion. Cost and parent of every pixel live in dense arrays that are kept
+ * between searches; a search bumps a stamp instead of clearing them, so routing many rivers on the same map allocates
+ * nothing after the first one. One pathfinder runs one search at a time.
+ */
+class ONEBUTTONLEVELGENERATION_API FOCGRiverPathfinder
+{
+public:
+	// Pixels from Start to the first sea pixel reached, Start first. False when no sea pixel can be reached
+	bool FindPath(const FOCGRiverCostField& Field, const FIntPoint& Start, TArray<FIntPoint>& OutPath);
+
+	// Pixels taken from the open list by the last search
+	FORCEINLINE int32 GetNumExpanded() const { return NumExpanded; }
+
+private:
+	struct FOpenNode
+	{
+		float Priority;
+		float Cost;
+		int32 Index;
+	};
+
+	void Reset(int32 NumPixels);
+
+	TArray<float> Costs;
+	TArray<int32> Parents;
+	// A pixel holds a valid cost and parent only when its stamp is the stamp of the running search
+	TArray<uint32> Stamps;
+	uint32 CurrentStamp = 0;
+	TArray<FOpenNode> OpenList;
+	int32 NumExpanded = 0;
+};